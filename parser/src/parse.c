@@ -2,13 +2,36 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#include <limits.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI /* wingdi.h defines ERROR */
+#include <windows.h>
+#include <process.h>
+#else
+#include <sys/mman.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCAN_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 /*
 parser 구현은 scanner와 함께 각 헤더파일, C파일을 나누지 않고 하나의 parse.c에서 처리함.
 단, 후에 구현의 편리함을 주석으로 경계구분.
 
-int EchoSource = FALSE; 를 해서 parsing 과정만 보이게 함.
+openSource에서 comp->EchoSource = FALSE; 를 해서 parsing 과정만 보이게 함.
 만약, Source도 같이 출력하고 싶다면, TRUE로 변경해주면 됨.
 */
 
@@ -16,6 +39,15 @@ int EchoSource = FALSE; 를 해서 parsing 과정만 보이게 함.
 #define FALSE 0
 #define TRUE 1
 
+/* ALWAYS_INLINE functions are inlined into every caller, so a
+   call with constant arguments becomes a copy specialized for
+   them (see scanToken) */
+#ifdef _MSC_VER
+#define ALWAYS_INLINE static __forceinline
+#else
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+#endif
+
 /* MAXRESERVED = the number of reserved words */
 #define MAXRESERVED 6 // else, if, int, return, void, while
 
@@ -37,10 +69,6 @@ typedef enum {
       STOP_BEFORE_END
 } TokenType;
 
-FILE* listing; /* listing output text file */
-int lineno = 0; /* source line number for listing */
-FILE* source; /* source code text file */
-
 /**************************************************/
 /***********   Syntax tree for parsing ************/
 /**************************************************/
@@ -54,17 +82,28 @@ typedef enum { Void, Integer } ExpType;
 
 #define MAXCHILDREN 3
 
+/* Lexeme is a view of a name inside the source buffer.
+   It is len bytes long and not NUL-terminated. Names in the
+   syntax tree come from the name pool (see internName): str is
+   the one canonical view of the name and id its handle, so two
+   names are the same exactly when their ids are equal */
+typedef struct {
+    const char* str;
+    int len;
+    int id;
+} Lexeme;
+
 typedef struct treeNode
 {
     struct treeNode* child[MAXCHILDREN];
     struct treeNode* sibling;
-    int lineno;
+    size_t offset; /* source offset of the token the node was made at (see lineOf) */
     NodeKind nodekind;
     union { StmtKind stmt; ExpKind exp; } kind;
     union {
         TokenType op;
         int val;
-        char* name;
+        Lexeme name;
     } attr;
     ExpType type; /* for type checking of exps */
     // include_param이 0이면 인자X
@@ -74,36 +113,174 @@ typedef struct treeNode
     int array_size;
 } TreeNode;
 
+/* TokenBuffer holds a run of tokens in struct-of-arrays form:
+   token i is kind[i], spelled by the source bytes
+   [offset[i], offset[i] + length[i]). Tokens carry no line
+   numbers; lineOf finds the line of an offset when needed */
+typedef struct {
+    int count; /* number of tokens in the buffer */
+    int capacity; /* number of tokens the arrays can hold */
+    unsigned char* kind; /* TokenType of each token */
+    size_t* offset;
+    int* length;
+    int* name; /* name pool handle of ID tokens, -1 for others */
+    int* value; /* tokenValue of NUM tokens, 0 for others */
+} TokenBuffer;
+
+/* Compiler holds the state of one compilation: the scanner, the
+   parser, the tree and the listing. compileFile makes one for each
+   source and hands it down to every function that needs it, so any
+   number of compilations can run side by side, on one thread or
+   on many (see openSource) */
+typedef struct compiler {
+    FILE* listing; /* listing output text file */
+    int lineno; /* source line number for the echo and TraceScan listing */
+    FILE* source; /* source code text file */
+
+    /* EchoSource = TRUE causes the source program to
+     * be echoed to the listing file with line numbers
+     * during parsing
+     */
+    int EchoSource;
+
+    /* TraceScan = TRUE causes token information to be
+     * printed to the listing file as each token is
+     * recognized by the scanner
+     */
+    int TraceScan;
+
+    /* TraceParse = TRUE causes the syntax tree to be
+     * printed to the listing file in linearized form
+     * (using indents for children)
+     */
+    int TraceParse;
+
+    /* Error = TRUE prevents further passes if an error occurs */
+    int Error;
+
+    /* UTIL.C */
+    char* outBuf; /* OUTBUFSIZE bytes of listing (see outFlush) */
+    size_t outLen; /* number of bytes waiting in outBuf */
+    struct arenaBlock* arena; /* the block being filled */
+    Lexeme* names; /* names[id] */
+    unsigned* nameHash; /* hash of names[id] */
+    int nameCount;
+    int nameCapacity;
+    int* nameSlots; /* open addressing over ids, -1 = empty */
+    int nameSlotCount; /* a power of two, at least 2 * nameCount */
+    int indentno; /* number of spaces printTree indents by */
+
+    /* SCAN.C: the last token */
+    /* tokenString points at the lexeme of the last token inside
+       the source buffer. It is tokenLength bytes long and is not
+       NUL-terminated, so lexemes of any length are never copied */
+    const char* tokenString;
+    size_t tokenLength;
+    size_t tokenOffset; /* position of tokenString in the source buffer */
+    int tokenName; /* name pool handle of the last ID token */
+    /* tokenValue is the value of the last NUM token, worked out
+       while it was scanned; -1 if it does not fit in an int */
+    int tokenValue;
+
+    /* SCAN.C: the source buffer */
+    const char* srcBuf; /* holds the whole source file */
+    size_t srcLen; /* size of srcBuf in bytes */
+    size_t srcPos; /* current position in srcBuf */
+    size_t lineEnd; /* end of the current line in srcBuf */
+    int srcMapped; /* srcBuf came from mmap (else malloc) */
+    int EOF_flag; /* corrects ungetNextChar behavior on EOF */
+    size_t* lineStart; /* offsets where lines begin (see lineOf) */
+    int lineCount; /* number of entries in lineStart */
+
+    /* PARSE.C */
+    TokenType token; /* holds current token */
+    TokenBuffer tokens; /* current batch of tokens from scanTokens */
+    int tokenIndex; /* index of the next token in tokens */
+    int panic; /* see unexpected */
+} Compiler;
+
+/* lineOf returns the line of a source offset (see SCAN.C) */
+int lineOf(Compiler* comp, size_t offset);
+/* compileFile compiles one source into one listing (see MAIN.C) */
+int compileFile(const char* SFile, const char* PFile, int* errors);
 
-/* EchoSource = TRUE causes the source program to
- * be echoed to the listing file with line numbers
- * during parsing
- */
-int EchoSource = FALSE;
+////////////////////////////////////////////////// UTIL.C 파일 ///////////////////////////////////////////
 
+/* The listing is written through outBuf, a large buffer that
+   goes to the listing file in one fwrite when it fills up (or on
+   outFlush), instead of one fprintf per token, line or space.
+   Numbers are formatted by hand and indentation is copied in
+   blocks. outFlush must run before the listing is closed. */
+#define OUTBUFSIZE (1 << 20)
 
-/* TraceScan = TRUE causes token information to be
- * printed to the listing file as each token is
- * recognized by the scanner
- */
-int TraceScan = FALSE;
+/* outFlush writes out everything waiting in outBuf */
+void outFlush(Compiler* comp)
+{
+    if (comp->outLen > 0)
+        fwrite(comp->outBuf, 1, comp->outLen, comp->listing);
+    comp->outLen = 0;
+}
 
-/* TraceParse = TRUE causes the syntax tree to be
- * printed to the listing file in linearized form
- * (using indents for children)
- */
-int TraceParse = TRUE;
+/* outChars appends the n bytes at s to the listing */
+static void outChars(Compiler* comp, const char* s, size_t n)
+{
+    if (n > OUTBUFSIZE - comp->outLen) {
+        outFlush(comp);
+        if (n >= OUTBUFSIZE) {
+            fwrite(s, 1, n, comp->listing);
+            return;
+        }
+    }
+    memcpy(comp->outBuf + comp->outLen, s, n);
+    comp->outLen += n;
+}
+
+/* outText appends a NUL-terminated string to the listing */
+static void outText(Compiler* comp, const char* s)
+{
+    outChars(comp, s, strlen(s));
+}
 
+/* outChar appends one character to the listing */
+static void outChar(Compiler* comp, char c)
+{
+    if (comp->outLen == OUTBUFSIZE) outFlush(comp);
+    comp->outBuf[comp->outLen++] = c;
+}
 
-/* Error = TRUE prevents further passes if an error occurs */
-int Error = FALSE;
+/* outSpaces appends n blanks to the listing */
+static void outSpaces(Compiler* comp, int n)
+{
+    static const char blanks[64] =
+        "                                                                ";
+    while (n > 0) {
+        int k = (n < 64) ? n : 64;
+        outChars(comp, blanks, k);
+        n -= k;
+    }
+}
 
-////////////////////////////////////////////////// UTIL.C 파일 ///////////////////////////////////////////
+/* outInt appends v in decimal, right-aligned in width
+   columns like printf's %*d */
+static void outInt(Compiler* comp, int v, int width)
+{
+    char digits[12];
+    int n = 0;
+    unsigned u = (v < 0) ? 0u - (unsigned)v : (unsigned)v;
+    do {
+        digits[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+    if (v < 0) digits[n++] = '-';
+    if (width > n) outSpaces(comp, width - n);
+    if (OUTBUFSIZE - comp->outLen < (size_t)n) outFlush(comp);
+    while (n > 0) comp->outBuf[comp->outLen++] = digits[--n];
+}
 
 /* Procedure printToken prints a token
-* and its lexeme to the listing file
+* and its lexeme (tokenLength bytes) to the listing file
 */
-void printToken(TokenType token, const char* tokenString)
+void printToken(Compiler* comp, TokenType token, const char* tokenString, size_t tokenLength)
 {
     switch (token)
     {
@@ -114,61 +291,132 @@ void printToken(TokenType token, const char* tokenString)
     case VOID:
     case WHILE:
 
-        fprintf(listing,
-            "reserved word: %s\n", tokenString);
+        outText(comp, "reserved word: ");
+        outChars(comp, tokenString, tokenLength);
+        outChar(comp, '\n');
         break;
-    case PLUS: fprintf(listing, "+\n"); break;
-    case MINUS: fprintf(listing, "-\n"); break;
-    case TIMES: fprintf(listing, "*\n"); break;
-    case OVER: fprintf(listing, "/\n"); break;
-    case LT: fprintf(listing, "<\n"); break;
-    case LTE: fprintf(listing, "<=\n"); break;
-    case GT: fprintf(listing, ">\n"); break;
-    case GTE: fprintf(listing, ">=\n"); break;
-    case EQ: fprintf(listing, "==\n"); break;
-    case NE: fprintf(listing, "!=\n"); break;
-    case ASSIGN: fprintf(listing, "=\n"); break; // TINY에서는 ':=' 이거지만, 여기서는 '='로 ASSIGN표현
-    case SEMI: fprintf(listing, ";\n"); break;
-    case COMMA: fprintf(listing, ",\n"); break;
-    case LPAREN: fprintf(listing, "(\n"); break;
-    case RPAREN: fprintf(listing, ")\n"); break;
-    case LBRACK: fprintf(listing, "[\n"); break;
-    case RBRACK: fprintf(listing, "]\n"); break;
-    case LBRACE: fprintf(listing, "{\n"); break;
-    case RBRACE: fprintf(listing, "}\n"); break;
-    case ENDFILE: fprintf(listing, "EOF\n"); break;
-    case STOP_BEFORE_END: fprintf(listing, "stop before ending\n"); break;
+    case PLUS: outText(comp, "+\n"); break;
+    case MINUS: outText(comp, "-\n"); break;
+    case TIMES: outText(comp, "*\n"); break;
+    case OVER: outText(comp, "/\n"); break;
+    case LT: outText(comp, "<\n"); break;
+    case LTE: outText(comp, "<=\n"); break;
+    case GT: outText(comp, ">\n"); break;
+    case GTE: outText(comp, ">=\n"); break;
+    case EQ: outText(comp, "==\n"); break;
+    case NE: outText(comp, "!=\n"); break;
+    case ASSIGN: outText(comp, "=\n"); break; // TINY에서는 ':=' 이거지만, 여기서는 '='로 ASSIGN표현
+    case SEMI: outText(comp, ";\n"); break;
+    case COMMA: outText(comp, ",\n"); break;
+    case LPAREN: outText(comp, "(\n"); break;
+    case RPAREN: outText(comp, ")\n"); break;
+    case LBRACK: outText(comp, "[\n"); break;
+    case RBRACK: outText(comp, "]\n"); break;
+    case LBRACE: outText(comp, "{\n"); break;
+    case RBRACE: outText(comp, "}\n"); break;
+    case ENDFILE: outText(comp, "EOF\n"); break;
+    case STOP_BEFORE_END: outText(comp, "stop before ending\n"); break;
     case NUM:
-        fprintf(listing,
-            "NUM, val= %s\n", tokenString);
+        outText(comp, "NUM, val= ");
+        outChars(comp, tokenString, tokenLength);
+        outChar(comp, '\n');
         break;
     case ID:
-        fprintf(listing,
-            "ID, name= %s\n", tokenString);
+        outText(comp, "ID, name= ");
+        outChars(comp, tokenString, tokenLength);
+        outChar(comp, '\n');
         break;
     case ERROR:
-        fprintf(listing,
-            "Error: %s\n", tokenString); // 에러토큰의 경우 "Error: 해당 error string"
+        outText(comp, "Error: ");
+        outChars(comp, tokenString, tokenLength);
+        outChar(comp, '\n'); // 에러토큰의 경우 "Error: 해당 error string"
         break;
     default: /* should never happen */
-        fprintf(listing, "Unknown token: %d\n", token);
+        outText(comp, "Unknown token: ");
+        outInt(comp, token, 0);
+        outChar(comp, '\n');
+    }
+}
+
+/* The syntax tree lives in an arena: nodes are cut from large
+ * blocks by bumping a pointer, so they need no malloc each and
+ * sit next to each other in the order they were built.
+ * resetArena drops the whole tree at once and keeps the first
+ * block to be used again; freeArena releases everything.
+ */
+#define ARENABLOCK (1 << 20) /* bytes in an arena block */
+#define ARENAALIGN sizeof(void*) /* the header keeps data word-aligned */
+
+typedef struct arenaBlock {
+    struct arenaBlock* next; /* the block filled before this one */
+    size_t size; /* bytes in data */
+    size_t used; /* data[0, used) is handed out */
+    unsigned char data[];
+} ArenaBlock;
+
+/* arenaAlloc returns n bytes from the arena, or NULL when
+ * out of memory
+ */
+static void* arenaAlloc(Compiler* comp, size_t n)
+{
+    n = (n + ARENAALIGN - 1) & ~(size_t)(ARENAALIGN - 1);
+    if (comp->arena == NULL || comp->arena->size - comp->arena->used < n) {
+        size_t size = (n > ARENABLOCK) ? n : ARENABLOCK;
+        ArenaBlock* b = (ArenaBlock*)malloc(sizeof(ArenaBlock) + size);
+        if (b == NULL)
+            return NULL;
+        b->next = comp->arena;
+        b->size = size;
+        b->used = 0;
+        comp->arena = b;
+    }
+    comp->arena->used += n;
+    return comp->arena->data + comp->arena->used - n;
+}
+
+/* resetArena frees every node of the tree, keeping the
+ * oldest block for the next tree
+ */
+void resetArena(Compiler* comp)
+{
+    while (comp->arena != NULL && comp->arena->next != NULL) {
+        ArenaBlock* next = comp->arena->next;
+        free(comp->arena);
+        comp->arena = next;
     }
+    if (comp->arena != NULL)
+        comp->arena->used = 0;
+}
+
+/* freeArena releases the arena */
+void freeArena(Compiler* comp)
+{
+    resetArena(comp);
+    free(comp->arena);
+    comp->arena = NULL;
 }
 
 /* Function newStmtNode creates a new statement
  * node for syntax tree construction
  */
-TreeNode* newStmtNode(StmtKind kind)
+TreeNode* newStmtNode(Compiler* comp, StmtKind kind)
 {
-    TreeNode* t = (TreeNode*)malloc(sizeof(TreeNode));
-    if (t == NULL)
-        fprintf(listing, "Out of memory error at line %d\n", lineno);
+    TreeNode* t = (TreeNode*)arenaAlloc(comp, sizeof(TreeNode));
+    if (t == NULL) {
+        outText(comp, "Out of memory error at line ");
+        outInt(comp, lineOf(comp, comp->tokenOffset), 0);
+        outChar(comp, '\n');
+    }
     else {
         for (int i = 0; i < MAXCHILDREN; i++) t->child[i] = NULL;
         t->sibling = NULL;
         t->nodekind = StmtK;
         t->kind.stmt = kind;
-        t->lineno = lineno;
+        t->offset = comp->tokenOffset;
+        memset(&t->attr, 0, sizeof(t->attr));
+        t->type = Void;
+        t->include_param = 0;
+        t->array_size = 0;
     }
     return t;
 }
@@ -176,155 +424,295 @@ TreeNode* newStmtNode(StmtKind kind)
 /* Function newExpNode creates a new expression
  * node for syntax tree construction
  */
-TreeNode* newExpNode(ExpKind kind)
+TreeNode* newExpNode(Compiler* comp, ExpKind kind)
 {
-    TreeNode* t = (TreeNode*)malloc(sizeof(TreeNode));
-    if (t == NULL)
-        fprintf(listing, "Out of memory error at line %d\n", lineno);
+    TreeNode* t = (TreeNode*)arenaAlloc(comp, sizeof(TreeNode));
+    if (t == NULL) {
+        outText(comp, "Out of memory error at line ");
+        outInt(comp, lineOf(comp, comp->tokenOffset), 0);
+        outChar(comp, '\n');
+    }
     else {
         for (int i = 0; i < MAXCHILDREN; i++) t->child[i] = NULL;
         t->sibling = NULL;
         t->nodekind = ExpK;
         t->kind.exp = kind;
-        t->lineno = lineno;
+        t->offset = comp->tokenOffset;
+        memset(&t->attr, 0, sizeof(t->attr));
         t->type = Void;
         t->include_param = 0;
+        t->array_size = 0;
     }
     return t;
 }
 
-/* Function copyString allocates and makes a new
- * copy of an existing string
+/* The name pool holds every distinct identifier once. The scanner
+ * interns each ID as it is scanned and the parser takes the handle
+ * from the token, so a name used many times is hashed once per use
+ * and never copied; the canonical text is its first occurrence in
+ * the source buffer.
  */
-char* copyString(char* s)
-{
-    if (s == NULL) return NULL;
-    int n = strlen(s) + 1;
-    char* t = malloc(n);
-    if (t == NULL)
-        fprintf(listing, "Out of memory error at line %d\n", lineno);
-    else strcpy(t, s);
-    return t;
+/* hashName is FNV-1a over the bytes of a name */
+static unsigned hashName(const char* s, int len)
+{
+    unsigned h = 2166136261u;
+    for (int i = 0; i < len; i++)
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    return h;
+}
+
+/* growNames doubles the name pool and its hash table.
+ * returns FALSE when out of memory
+ */
+static int growNames(Compiler* comp)
+{
+    int cap = (comp->nameCapacity == 0) ? 256 : comp->nameCapacity * 2;
+    int slotCount = cap * 2;
+    Lexeme* grownNames = (Lexeme*)realloc(comp->names, cap * sizeof(Lexeme));
+    unsigned* grownHash;
+    int* slots;
+    if (grownNames == NULL)
+        return FALSE;
+    comp->names = grownNames;
+    grownHash = (unsigned*)realloc(comp->nameHash, cap * sizeof(unsigned));
+    if (grownHash == NULL)
+        return FALSE;
+    comp->nameHash = grownHash;
+    slots = (int*)malloc(slotCount * sizeof(int));
+    if (slots == NULL)
+        return FALSE;
+    for (int i = 0; i < slotCount; i++) slots[i] = -1;
+    for (int id = 0; id < comp->nameCount; id++) {
+        unsigned j = comp->nameHash[id] & (slotCount - 1);
+        while (slots[j] != -1) j = (j + 1) & (slotCount - 1);
+        slots[j] = id;
+    }
+    free(comp->nameSlots);
+    comp->nameSlots = slots;
+    comp->nameSlotCount = slotCount;
+    comp->nameCapacity = cap;
+    return TRUE;
 }
 
-/* Variable indentno is used by printTree to
- * store current number of spaces to indent
+/* internName returns the handle of the name s (len bytes),
+ * adding it to the pool on first use; s must outlive the pool.
+ * returns -1 when out of memory
  */
-static int indentno = 0;
+int internName(Compiler* comp, const char* s, int len)
+{
+    unsigned h = hashName(s, len);
+    unsigned j;
+    if (comp->nameCount == comp->nameCapacity && !growNames(comp))
+        return -1;
+    j = h & (comp->nameSlotCount - 1);
+    while (comp->nameSlots[j] != -1) {
+        int id = comp->nameSlots[j];
+        if (comp->nameHash[id] == h && comp->names[id].len == len && memcmp(comp->names[id].str, s, len) == 0)
+            return id;
+        j = (j + 1) & (comp->nameSlotCount - 1);
+    }
+    comp->names[comp->nameCount].str = s;
+    comp->names[comp->nameCount].len = len;
+    comp->names[comp->nameCount].id = comp->nameCount;
+    comp->nameHash[comp->nameCount] = h;
+    comp->nameSlots[j] = comp->nameCount;
+    return comp->nameCount++;
+}
+
+/* nameOf returns the canonical Lexeme of the handle id */
+Lexeme nameOf(Compiler* comp, int id)
+{
+    Lexeme none = { "", 0, -1 };
+    return (id >= 0) ? comp->names[id] : none;
+}
+
+/* freeNames releases the name pool */
+void freeNames(Compiler* comp)
+{
+    free(comp->names);
+    free(comp->nameHash);
+    free(comp->nameSlots);
+    comp->names = NULL;
+    comp->nameHash = NULL;
+    comp->nameSlots = NULL;
+    comp->nameCount = comp->nameCapacity = comp->nameSlotCount = 0;
+}
 
-/* macros to increase/decrease indentation */
-#define INDENT indentno+=2
-#define UNINDENT indentno-=2
+/* macros to increase/decrease indentation
+ * (indentno is the number of spaces printTree indents by)
+ */
+#define INDENT(comp) (comp)->indentno+=2
+#define UNINDENT(comp) (comp)->indentno-=2
 
 /* printSpaces indents by printing spaces */
-static void printSpaces(void)
+static void printSpaces(Compiler* comp)
+{
+    outSpaces(comp, comp->indentno);
+}
+
+/* printDecl prints "[ what => name : NAME (type)" for a
+ * declaration node; the caller finishes the line
+ */
+static void printDecl(Compiler* comp, const char* what, Lexeme name, ExpType type)
+{
+    outText(comp, "[ ");
+    outText(comp, what);
+    outText(comp, " => name : ");
+    outChars(comp, name.str, name.len);
+    outText(comp, (type == Integer) ? " (int)" : " (void)");
+}
+
+/* printNode prints the line of one tree node */
+static void printNode(Compiler* comp, const TreeNode* tree)
 {
-    for (int i = 0; i < indentno; i++) {
-        fprintf(listing, " ");
+    if (tree->nodekind == StmtK)
+    {
+        switch (tree->kind.stmt) {
+        case compound_stmtK:
+            outText(comp, "Compound-stmt :\n");
+            break;
+        case selection_stmtK:
+            if (tree->child[2] == NULL) {
+                outText(comp, "If-stmt (else 미포함) :\n");
+            }
+            else {
+                outText(comp, "If-stmt (else 포함) :\n");
+            }
+            break;
+        case iteration_stmtK:
+            outText(comp, "While-stmt (iteration) :\n");
+            break;
+        case return_stmtK:
+            if (tree->child[0] == NULL) {
+                outText(comp, "Return; \n");
+            }
+            else {
+                outText(comp, "Return-stmt :\n");
+            }
+            break;
+        case callK:
+            outText(comp, "Call-stmt : ");
+            outChars(comp, tree->attr.name.str, tree->attr.name.len);
+            outText(comp, " \n");
+            break;
+        default:
+            outText(comp, "Unknown ExpNode kind\n");
+            break;
+        }
+    }
+    else if (tree->nodekind == ExpK)
+    {
+        switch (tree->kind.exp) {
+        case checkArrayVarK:
+            if (tree->include_param == 1) {
+                printDecl(comp, "Parameter in Array", tree->attr.name, tree->type);
+                outText(comp, " ] \n");
+            }
+            else {
+                printDecl(comp, "Declaration of Array", tree->attr.name, tree->type);
+                outText(comp, ", (array_size : ");
+                outInt(comp, tree->array_size, 0);
+                outText(comp, ") ]\n");
+            }
+            break;
+        case checkVarK:
+            if (tree->include_param == 1) {
+                printDecl(comp, "Parameter variable", tree->attr.name, tree->type);
+                outText(comp, " ]\n");
+            }
+            else {
+                printDecl(comp, "Declaration of variable", tree->attr.name, tree->type);
+                outText(comp, " ]\n");
+            }
+            break;
+        case fun_declarationK:
+            printDecl(comp, "func-declaration", tree->attr.name, tree->type);
+            outText(comp, " ]\n");
+            break;
+        case OpK:
+            outText(comp, "Op : ");
+            printToken(comp, tree->attr.op, "", 0);
+            break;
+        case ConstK:
+            outText(comp, "Const: ");
+            outInt(comp, tree->attr.val, 0);
+            outChar(comp, '\n');
+            break;
+        case IdK:
+            outText(comp, "Id : ");
+            outChars(comp, tree->attr.name.str, tree->attr.name.len);
+            outChar(comp, '\n');
+            break;
+        case AssignK:
+            outText(comp, "Assign : (좌=우) \n");
+            break;
+        default:
+            outText(comp, "Unknown ExpNode kind\n");
+            break;
+        }
     }
+    else outText(comp, "Unknown node kind\n");
 }
 
+/* TreeFrame is a node on printTree's path from the top level */
+typedef struct {
+    const TreeNode* node;
+    int child; /* next child list to print */
+} TreeFrame;
+
 /* procedure printTree prints a syntax tree to the
- * listing file using indentation to indicate subtrees
+ * listing file using indentation to indicate subtrees.
+ * It walks the tree with its own stack instead of
+ * recursing, so deep trees cannot overflow the C stack
  */
-void printTree(TreeNode* tree)
+void printTree(Compiler* comp, TreeNode* tree)
 {
-    int i;
-    INDENT;
-    while (tree != NULL) {
-        printSpaces();
-        if (tree->nodekind == StmtK)
-        {
-            switch (tree->kind.stmt) {
-            case compound_stmtK:
-                fprintf(listing, "Compound-stmt :\n");
-                break;
-            case selection_stmtK:
-                if (tree->child[2] == NULL) {
-                    fprintf(listing, "If-stmt (else 미포함) :\n");
-                }
-                else {
-                    fprintf(listing, "If-stmt (else 포함) :\n");
-                }
-                break;
-            case iteration_stmtK:
-                fprintf(listing, "While-stmt (iteration) :\n");
-                break;
-            case return_stmtK:
-                if (tree->child[0] == NULL) {
-                    fprintf(listing, "Return; \n");
-                }
-                else {
-                    fprintf(listing, "Return-stmt :\n");
-                }
-                break;
-            case callK:
-                if (tree->child[0] == NULL) {
-                    fprintf(listing, "Call-stmt : %s \n", tree->attr.name);
-                }
-                else {
-                    fprintf(listing, "Call-stmt : %s \n", tree->attr.name);
+    TreeFrame* stack = NULL;
+    int depth = 0, capacity = 0;
+    const TreeNode* t = tree;
+    INDENT(comp);
+    for (;;) {
+        if (t != NULL) {
+            if (depth == capacity) {
+                int cap = (capacity == 0) ? 64 : capacity * 2;
+                TreeFrame* grown = (TreeFrame*)realloc(stack, cap * sizeof(TreeFrame));
+                if (grown == NULL) {
+                    outText(comp, "Out of memory error\n");
+                    comp->indentno -= 2 * depth;
+                    break;
                 }
-                break;
-            default:
-                fprintf(listing, "Unknown ExpNode kind\n");
-                break;
+                stack = grown;
+                capacity = cap;
             }
+            printSpaces(comp);
+            printNode(comp, t);
+            stack[depth].node = t;
+            stack[depth].child = 0;
+            depth++;
+            INDENT(comp); /* for the children of t */
+            t = NULL;
         }
-        else if (tree->nodekind == ExpK)
-        {
-            switch (tree->kind.exp) {
-            case checkArrayVarK:
-                if (tree->include_param == 1) {
-                    fprintf(listing, "[ Parameter in Array => name : %s (%s) ] \n", tree->attr.name, ((tree->type == Integer) ? "int" : "void"));
-                }
-                else {
-                    fprintf(listing, "[ Declaration of Array => name : %s (%s), (array_size : %d) ]\n", tree->attr.name, ((tree->type == Integer) ? "int" : "void"), tree->array_size);
-                }
-                break;
-            case checkVarK:
-                if (tree->include_param == 1) {
-                    fprintf(listing, "[ Parameter variable => name : %s (%s) ]\n", tree->attr.name, ((tree->type == Integer) ? "int" : "void"));
-                }
-                else {
-                    fprintf(listing, "[ Declaration of variable => name : %s (%s) ]\n", tree->attr.name, ((tree->type == Integer) ? "int" : "void"));
-                }
-                break;
-            case fun_declarationK:
-                fprintf(listing, "[ func-declaration => name : %s (%s) ]\n", tree->attr.name, ((tree->type == Integer) ? "int" : "void"));
-                break;
-            case OpK:
-                fprintf(listing, "Op : ");
-                printToken(tree->attr.op, "\0");
-                break;
-            case ConstK:
-                fprintf(listing, "Const: %d\n", tree->attr.val);
-                break;
-            case IdK:
-                fprintf(listing, "Id : %s\n", tree->attr.name);
-                break;
-            case AssignK:
-                fprintf(listing, "Assign : (좌=우) \n");
-                break;
-            default:
-                fprintf(listing, "Unknown ExpNode kind\n");
-                break;
+        else if (depth == 0)
+            break;
+        else {
+            TreeFrame* top = &stack[depth - 1];
+            if (top->child < MAXCHILDREN)
+                t = top->node->child[top->child++];
+            else {
+                /* t and its children are done: on to its sibling */
+                UNINDENT(comp);
+                t = top->node->sibling;
+                depth--;
             }
         }
-        else fprintf(listing, "Unknown node kind\n");
-        for (i = 0; i < MAXCHILDREN; i++)
-            printTree(tree->child[i]);
-        tree = tree->sibling;
     }
-    UNINDENT;
+    UNINDENT(comp);
+    free(stack);
 }
 
 ////////////////////////////////////////////////// SCAN.H 헤더 파일 ///////////////////////////////////////////
-/* MAXTOKENLEN is the maximum size of a token */
-#define MAXTOKENLEN 40
-
-/* tokenString array stores the lexeme of each token */
-char tokenString[MAXTOKENLEN + 1]; // SCAN.C파일에도 들어감
+/* TOKENCHUNK = number of tokens scanned per batch */
+#define TOKENCHUNK 65536
 
 
 
@@ -333,371 +721,787 @@ char tokenString[MAXTOKENLEN + 1]; // SCAN.C파일에도 들어감
 typedef enum {
     // 기존 TINY참고자료에 비해 추가되는 state는 2개의 연산자가 겹쳐 표현되는 것들
     // 즉, ==, <=, >=, !=, /*, */ 을 순서대로 IN_ASSIGN, IN_LT, IN_GT, IN_NE, IN_OVER로 state표현
-    START, IN_ASSIGN, IN_COMMENT, IN_NUM, IN_ID, DONE, IN_LT, IN_GT, IN_NE, IN_OVER
+    // IN_COMMENT_STAR는 comment 안에서 '*'를 읽은 상태 ('*/'로 닫히는지 확인)
+    START, IN_ASSIGN, IN_COMMENT, IN_NUM, IN_ID, DONE, IN_LT, IN_GT, IN_NE, IN_OVER,
+    IN_COMMENT_STAR,
+    NUMSTATES
 }StateType;
 
+/* character classes of the lexer DFA */
+typedef enum {
+    CC_OTHER, CC_LETTER, CC_DIGIT, CC_BLANK,
+    CC_ASSIGN, CC_LT, CC_GT, CC_BANG, CC_SLASH, CC_STAR,
+    CC_PLUS, CC_MINUS, CC_LPAREN, CC_RPAREN, CC_LBRACE, CC_RBRACE,
+    CC_LBRACK, CC_RBRACK, CC_SEMI, CC_COMMA,
+    CC_EOF,
+    NUMCLASSES
+} CharClass;
+
+/* charClass maps every input byte to its CharClass.
+   Plain ASCII ranges are used, so the scanner does not
+   depend on the current locale the way isalpha/isdigit do */
+static const unsigned char charClass[256] = {
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 00-07 */
+    CC_OTHER, CC_BLANK, CC_BLANK, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 08-0F */
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 10-17 */
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 18-1F */
+    CC_BLANK, CC_BANG, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 20-27 */
+    CC_LPAREN, CC_RPAREN, CC_STAR, CC_PLUS, CC_COMMA, CC_MINUS, CC_OTHER, CC_SLASH, /* 28-2F */
+    CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, /* 30-37 */
+    CC_DIGIT, CC_DIGIT, CC_OTHER, CC_SEMI, CC_LT, CC_ASSIGN, CC_GT, CC_OTHER, /* 38-3F */
+    CC_OTHER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 40-47 */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 48-4F */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 50-57 */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LBRACK, CC_OTHER, CC_RBRACK, CC_OTHER, CC_OTHER, /* 58-5F */
+    CC_OTHER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 60-67 */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 68-6F */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 70-77 */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LBRACE, CC_OTHER, CC_RBRACE, CC_OTHER, CC_OTHER, /* 78-7F */
+    /* 80-FF: CC_OTHER */
+};
+
+
+/* The whole source file is mapped into srcBuf once and
+   getNextChar scans straight over the mapped bytes.
+   lineEnd marks the end of the current line so that
+   lineno and EchoSource still work line by line. */
 
-/* BUFLEN = length of the input buffer for
-   source code lines */
-#define BUFLEN 256
+/* mapSource loads the whole source file into srcBuf.
+   It maps the file where possible and falls back to reading
+   it in one piece (pipes, platforms without mmap).
+   returns FALSE if the file cannot be read */
+static int mapSource(Compiler* comp, FILE* fp)
+{
+    char* buf = NULL;
+    size_t cap = 0;
+    size_t n;
+#ifndef _WIN32
+    struct stat st;
+    if (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            comp->srcBuf = "";
+            comp->srcLen = 0;
+            return TRUE;
+        }
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+        if (p != MAP_FAILED) {
+            comp->srcBuf = (const char*)p;
+            comp->srcLen = (size_t)st.st_size;
+            comp->srcMapped = TRUE;
+            return TRUE;
+        }
+    }
+#endif
+    comp->srcLen = 0;
+    do {
+        if (comp->srcLen == cap) {
+            char* grown;
+            cap = (cap == 0) ? 65536 : cap * 2;
+            grown = (char*)realloc(buf, cap);
+            if (grown == NULL) {
+                free(buf);
+                return FALSE;
+            }
+            buf = grown;
+        }
+        n = fread(buf + comp->srcLen, 1, cap - comp->srcLen, fp);
+        comp->srcLen += n;
+    } while (n > 0);
+    if (ferror(fp)) {
+        free(buf);
+        return FALSE;
+    }
+    if (comp->srcLen == 0) {
+        /* empty input looks like an empty file: unmapSource
+           only frees srcBuf when srcLen > 0 */
+        free(buf);
+        comp->srcBuf = "";
+        return TRUE;
+    }
+    comp->srcBuf = buf;
+    return TRUE;
+}
 
-static char lineBuf[BUFLEN]; /* holds the current line */
-static int linepos = 0; /* current position in LineBuf */
-static int bufsize = 0; /* current size of buffer string */
-static int EOF_flag = FALSE; /* corrects ungetNextChar behavior on EOF */
-int paramcheck = 0;
-int RPARENcheck = 0;
+/* unmapSource releases srcBuf */
+static void unmapSource(Compiler* comp)
+{
+#ifndef _WIN32
+    if (comp->srcMapped) munmap((void*)comp->srcBuf, comp->srcLen);
+    else
+#endif
+    if (comp->srcLen > 0) free((void*)comp->srcBuf);
+    comp->srcBuf = NULL;
+    comp->srcLen = comp->srcPos = comp->lineEnd = 0;
+    comp->srcMapped = FALSE;
+    comp->EOF_flag = FALSE;
+    free(comp->lineStart);
+    comp->lineStart = NULL;
+    comp->lineCount = 0;
+}
 
-/* getNextChar fetches the next non-blank character
-   from lineBuf, reading in a new line if lineBuf is
-   exhausted */
-static int getNextChar(void)
+/* getNextChar fetches the next character from srcBuf,
+   moving on to the next line (and echoing it if echo) when
+   the current line is exhausted */
+ALWAYS_INLINE int getNextChar(Compiler* comp, int echo)
 {
-    if (!(linepos < bufsize))
+    if (!(comp->srcPos < comp->lineEnd))
     {
-        lineno++;
-        if (fgets(lineBuf, BUFLEN - 1, source)) {
-            if (EchoSource) fprintf(listing, "%4d: %s", lineno, lineBuf);
-            bufsize = strlen(lineBuf);
-            linepos = 0;
-            return lineBuf[linepos++]; // ++후위연산
+        comp->lineno++;
+        if (comp->srcPos < comp->srcLen) {
+            const char* nl = memchr(comp->srcBuf + comp->srcPos, '\n', comp->srcLen - comp->srcPos);
+            comp->lineEnd = (nl != NULL) ? (size_t)(nl - comp->srcBuf) + 1 : comp->srcLen;
+            if (echo) {
+                outInt(comp, comp->lineno, 4);
+                outText(comp, ": ");
+                outChars(comp, comp->srcBuf + comp->srcPos, comp->lineEnd - comp->srcPos);
+            }
+            return (unsigned char)comp->srcBuf[comp->srcPos++]; // ++후위연산
         }
         else {
-            EOF_flag = TRUE;
+            comp->EOF_flag = TRUE;
             return EOF;
         }
     }
     else
-        return lineBuf[linepos++];
+        return (unsigned char)comp->srcBuf[comp->srcPos++];
+}
+
+/* ungetNextChar backtracks one character in srcBuf.
+   lineEnd is kept, so backing up over the first character
+   of a line does not count or echo that line twice */
+static void ungetNextChar(Compiler* comp) {
+    if (!comp->EOF_flag) comp->srcPos--;
+}
+
+/* Fast paths for getToken: blanks, comment bodies and letter
+   runs are skipped a whole block at a time (32 bytes with AVX2,
+   16 with SSE2) instead of one getNextChar call per byte.
+   Digit runs are converted as they are skipped (spanNumber).
+   They never look past lineEnd, so lineno and EchoSource are
+   still handled by getNextChar. */
+#if defined(SCAN_AVX2)
+#define SIMD_WIDTH 32
+#define SIMD_FULL 0xFFFFFFFFu
+typedef __m256i simd_t;
+#define simdLoad(p) _mm256_loadu_si256((const __m256i*)(p))
+#define simdSet(c) _mm256_set1_epi8((char)(c))
+#define simdEq(a, b) _mm256_cmpeq_epi8(a, b)
+#define simdLt(a, b) _mm256_cmpgt_epi8(b, a)
+#define simdOr(a, b) _mm256_or_si256(a, b)
+#define simdAdd(a, b) _mm256_add_epi8(a, b)
+#define simdMask(a) ((unsigned)_mm256_movemask_epi8(a))
+#elif defined(SCAN_SSE2)
+#define SIMD_WIDTH 16
+#define SIMD_FULL 0xFFFFu
+typedef __m128i simd_t;
+#define simdLoad(p) _mm_loadu_si128((const __m128i*)(p))
+#define simdSet(c) _mm_set1_epi8((char)(c))
+#define simdEq(a, b) _mm_cmpeq_epi8(a, b)
+#define simdLt(a, b) _mm_cmplt_epi8(a, b)
+#define simdOr(a, b) _mm_or_si128(a, b)
+#define simdAdd(a, b) _mm_add_epi8(a, b)
+#define simdMask(a) ((unsigned)_mm_movemask_epi8(a))
+#endif
+
+#ifdef SIMD_WIDTH
+/* lowestBit returns the index of the lowest set bit of m (m != 0) */
+static int lowestBit(unsigned m)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return (int)i;
+#else
+    return __builtin_ctz(m);
+#endif
+}
+
+/* simdRange marks the bytes of v in [lo, lo + n) using a
+   signed compare on bytes shifted by 0x80 - lo */
+static simd_t simdRange(simd_t v, int lo, int n)
+{
+    return simdLt(simdAdd(v, simdSet(0x80 - lo)), simdSet(n - 0x80));
+}
+#endif
+
+/* skipBlanks returns the first position in [pos, end)
+   that is not a blank, tab or newline */
+static size_t skipBlanks(Compiler* comp, size_t pos, size_t end)
+{
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        simd_t v = simdLoad(comp->srcBuf + pos);
+        unsigned m = simdMask(simdOr(simdOr(simdEq(v, simdSet(' ')), simdEq(v, simdSet('\t'))), simdEq(v, simdSet('\n'))));
+        if (m != SIMD_FULL) return pos + lowestBit(~m);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && (comp->srcBuf[pos] == ' ' || comp->srcBuf[pos] == '\t' || comp->srcBuf[pos] == '\n')) pos++;
+    return pos;
+}
+
+/* findStar returns the position of the next '*' in [pos, end),
+   i.e. the only place a comment can be closed */
+static size_t findStar(Compiler* comp, size_t pos, size_t end)
+{
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        unsigned m = simdMask(simdEq(simdLoad(comp->srcBuf + pos), simdSet('*')));
+        if (m != 0) return pos + lowestBit(m);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && comp->srcBuf[pos] != '*') pos++;
+    return pos;
+}
+
+/* spanLetters returns the end of the run of letters starting at pos */
+static size_t spanLetters(Compiler* comp, size_t pos, size_t end)
+{
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        unsigned m = simdMask(simdRange(simdOr(simdLoad(comp->srcBuf + pos), simdSet(0x20)), 'a', 26));
+        if (m != SIMD_FULL) return pos + lowestBit(~m);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && charClass[(unsigned char)comp->srcBuf[pos]] == CC_LETTER) pos++;
+    return pos;
+}
+
+/* addDigit returns value * 10 + digit c, or -1 once
+   the number does not fit in an int */
+static int addDigit(int value, int c)
+{
+    int d = c - '0';
+    if (value < 0 || value > (INT_MAX - d) / 10)
+        return -1;
+    return value * 10 + d;
+}
+
+/* spanNumber returns the end of the run of digits starting at pos,
+   adding them to *value on the way */
+static size_t spanNumber(Compiler* comp, size_t pos, size_t end, int* value)
+{
+    int v = *value;
+    while (pos < end && charClass[(unsigned char)comp->srcBuf[pos]] == CC_DIGIT)
+        v = addDigit(v, comp->srcBuf[pos++]);
+    *value = v;
+    return pos;
+}
+
+/* Line numbers of tokens and tree nodes are not tracked while
+   scanning and parsing. They carry source offsets, and the first
+   lineOf call (a syntax error, say) builds lineStart, the offsets at
+   which lines begin, in one vectorized pass over srcBuf. A line starts
+   at offset 0 and after every newline, so the end of a file that
+   ends with a newline is on the line after the last one, as
+   getNextChar counts it. */
+#ifdef SIMD_WIDTH
+/* bitCount returns the number of set bits of m */
+static int bitCount(unsigned m)
+{
+#ifdef _MSC_VER
+    return (int)__popcnt(m);
+#else
+    return __builtin_popcount(m);
+#endif
 }
+#endif
 
-/* ungetNextChar backtracks one character in lineBuf */
-static void ungetNextChar(void) {
-    if (!EOF_flag) linepos--;
+/* buildLineIndex fills lineStart from srcBuf.
+   returns FALSE when out of memory */
+static int buildLineIndex(Compiler* comp)
+{
+    size_t pos = 0, n = 1;
+    const char* nl;
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= comp->srcLen) {
+        n += bitCount(simdMask(simdEq(simdLoad(comp->srcBuf + pos), simdSet('\n'))));
+        pos += SIMD_WIDTH;
+    }
+#endif
+    for (; pos < comp->srcLen; pos++)
+        n += (comp->srcBuf[pos] == '\n');
+    comp->lineStart = (size_t*)malloc(n * sizeof(size_t));
+    if (comp->lineStart == NULL)
+        return FALSE;
+    comp->lineStart[0] = 0;
+    comp->lineCount = 1;
+    pos = 0;
+    while (pos < comp->srcLen && (nl = memchr(comp->srcBuf + pos, '\n', comp->srcLen - pos)) != NULL) {
+        pos = (size_t)(nl - comp->srcBuf) + 1;
+        comp->lineStart[comp->lineCount++] = pos;
+    }
+    return TRUE;
+}
+
+/* lineOf returns the line (from 1) that holds source offset */
+int lineOf(Compiler* comp, size_t offset)
+{
+    int lo = 1, hi;
+    if (comp->lineStart == NULL && !buildLineIndex(comp))
+        return 0;
+    /* find the number of lines that start at or before offset */
+    hi = comp->lineCount;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (comp->lineStart[mid] <= offset) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
 }
 
-/* lookup table of reserved words */
-static struct {
-    char* str;
+/* lookup table of reserved words, indexed by RESERVEDHASH.
+   The hash mixes the first character with the length and puts
+   each of the MAXRESERVED words in its own slot, so an identifier
+   is compared against at most one candidate. */
+#define RESERVEDSLOTS 8
+#define RESERVEDHASH(s, len) ((((unsigned char)(s)[0] >> 1) + ((len) << 2)) & (RESERVEDSLOTS - 1))
+
+static const struct {
+    const char* str;
+    size_t len;
     TokenType tok;
 }
-reservedWords[MAXRESERVED] // 지정해주신 keyworkds는 6개
-= { {"else",ELSE} ,{"if",IF}, {"int",INT},
-    {"return",RETURN}, {"void",VOID}, {"while", WHILE}
+reservedWords[RESERVEDSLOTS] // 지정해주신 keyworkds는 6개, 빈 slot은 len 0
+= { {"int", 3, INT}, {"return", 6, RETURN}, {"else", 4, ELSE}, {"void", 4, VOID},
+    {"if", 2, IF}, {NULL, 0, ID}, {NULL, 0, ID}, {"while", 5, WHILE}
 };
 
 /* lookup an identifier to see if it is a reserved word */
-/* uses linear search */
-static TokenType reservedLookup(char* s) {
-    int i;
-    for (i = 0; i < MAXRESERVED; i++)
-        if (!strcmp(s, reservedWords[i].str))
-            return reservedWords[i].tok;
+/* uses the perfect hash above: one length check and one memcmp */
+static TokenType reservedLookup(const char* s, size_t len) {
+    int h;
+    if (len < 2 || len > 6) // reserved word 길이는 2~6
+        return ID;
+    h = RESERVEDHASH(s, len);
+    if (reservedWords[h].len == len && memcmp(s, reservedWords[h].str, len) == 0)
+        return reservedWords[h].tok;
     return ID;
 }
 
 
+/* transition table of the lexer DFA, indexed by [state][CharClass].
+   GO moves to another state and keeps the character in the lexeme,
+   ACCEPT finishes a token that includes the character and
+   BACKUP finishes a token before it (ungetNextChar) */
+typedef struct {
+    unsigned char next; /* next state */
+    unsigned char token; /* token returned when next == DONE */
+    unsigned char unget; /* TRUE if the character is not part of the token */
+} Transition;
+
+#define GO(s) { s, ERROR, FALSE }
+#define ACCEPT(t) { DONE, t, FALSE }
+#define BACKUP(t) { DONE, t, TRUE }
+
+static const Transition transition[NUMSTATES][NUMCLASSES] = {
+    /* START */
+    {
+        ACCEPT(ERROR), GO(IN_ID), GO(IN_NUM), GO(START), GO(IN_ASSIGN), GO(IN_LT), GO(IN_GT),
+        GO(IN_NE), GO(IN_OVER), ACCEPT(TIMES), ACCEPT(PLUS), ACCEPT(MINUS), ACCEPT(LPAREN), ACCEPT(RPAREN),
+        ACCEPT(LBRACE), ACCEPT(RBRACE), ACCEPT(LBRACK), ACCEPT(RBRACK), ACCEPT(SEMI), ACCEPT(COMMA), ACCEPT(ENDFILE)
+    },
+    /* IN_ASSIGN */
+    {
+        BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), ACCEPT(EQ), BACKUP(ASSIGN), BACKUP(ASSIGN),
+        BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN),
+        BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN)
+    },
+    /* IN_COMMENT */
+    {
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT),
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT_STAR), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT),
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), ACCEPT(STOP_BEFORE_END)
+    },
+    /* IN_NUM */
+    {
+        BACKUP(NUM), BACKUP(NUM), GO(IN_NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM),
+        BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM),
+        BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM)
+    },
+    /* IN_ID */
+    {
+        BACKUP(ID), GO(IN_ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID),
+        BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID),
+        BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID)
+    },
+    /* DONE (never read) */
+    {
+        ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR),
+        ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR),
+        ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR)
+    },
+    /* IN_LT */
+    {
+        BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), ACCEPT(LTE), BACKUP(LT), BACKUP(LT),
+        BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT),
+        BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT)
+    },
+    /* IN_GT */
+    {
+        BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), ACCEPT(GTE), BACKUP(GT), BACKUP(GT),
+        BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT),
+        BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT)
+    },
+    /* IN_NE */
+    {
+        BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), ACCEPT(NE), BACKUP(ERROR), BACKUP(ERROR),
+        BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR),
+        BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR)
+    },
+    /* IN_OVER */
+    {
+        BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER),
+        BACKUP(OVER), BACKUP(OVER), GO(IN_COMMENT), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER),
+        BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER)
+    },
+    /* IN_COMMENT_STAR */
+    {
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT),
+        GO(IN_COMMENT), GO(START), GO(IN_COMMENT_STAR), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT),
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), ACCEPT(STOP_BEFORE_END)
+    },
+};
+
+#undef GO
+#undef ACCEPT
+#undef BACKUP
+
+
 /****************************************/
 /* the primary function of the scanner  */
 /****************************************/
-/* function getToken returns the next token in source file */
-
-TokenType getToken()
-{  /* index for storing into tokenString */
-    int tokenStringIndex = 0;
+/* function scanToken returns the next token in source file.
+   It runs the transition table one character at a time;
+   the fast paths take over inside blanks, comments and ID/NUM runs.
+   echo and trace stand for EchoSource and TraceScan. They are
+   always constants, so each call (see getToken) is a copy of the
+   scanner with the checks for them folded away */
+
+ALWAYS_INLINE TokenType scanToken(Compiler* comp, int echo, int trace)
+{  /* start of the current lexeme in srcBuf */
+    size_t tokStart = comp->srcPos;
     /* holds current token to be returned */
-    TokenType currentToken; //리턴되어질 현재토큰
+    TokenType currentToken = ERROR; //리턴되어질 현재토큰
     /* current state - always begins at START */
     StateType state = START;
-    /* flag to indicate save to tokenString */
-    int save;
+    size_t len;
+    int value = 0; /* value of a NUM lexeme so far */
     while (state != DONE)  // state가 DONE이 아니라면 계속 돌아감
     {
-        int c = getNextChar();
-        save = TRUE;
+        int c = getNextChar(comp, echo);
+        const Transition* t = &transition[state][(c == EOF) ? CC_EOF : charClass[c]];
+        if (state == START && c != EOF)
+            tokStart = comp->srcPos - 1; // 공백, comment가 끝난 뒤 새 lexeme 시작
+        if (t->unget)
+            ungetNextChar(comp);
+        state = (StateType)t->next;
+        currentToken = (TokenType)t->token;
         switch (state) {
         case START:
-            if (isdigit(c))
-                state = IN_NUM;
-            else if (isalpha(c))
-                state = IN_ID;
-
-            /* White space consists of blanks, newlines, and tabs
-               White space is ignored except that it must separate ID’s, NUM’s, and
-               keywords.*/
-            else if ((c == ' ') || (c == '\t') || (c == '\n')) {
-                save = FALSE;
-            }
-            else if (c == '=') {
-                save = FALSE;
-                state = IN_ASSIGN;
-            }
-            else if (c == '<') {
-                save = FALSE;
-                state = IN_LT;
-            }
-            else if (c == '>') {
-                save = FALSE;
-                state = IN_GT;
-            }
-            else if (c == '!') {
-                save = FALSE;
-                state = IN_NE;
-            }
-            else if (c == '/') {
-                save = FALSE;
-                state = IN_OVER;
-            }
-            else {
-                state = DONE;
-                switch (c) {
-                case EOF:
-                    save = FALSE;
-                    currentToken = ENDFILE;
-                    break;
-                case '+':
-                    currentToken = PLUS;
-                    break;
-                case '-':
-                    currentToken = MINUS;
-                    break;
-                case '*':
-                    currentToken = TIMES;
-                    break;
-                case '(':
-                    currentToken = LPAREN;
-                    break;
-                case ')':
-                    currentToken = RPAREN;
-                    break;
-                case '{':
-                    currentToken = LBRACE;
-                    break;
-                case '}':
-                    currentToken = RBRACE;
-                    break;
-                case '[':
-                    currentToken = LBRACK;
-                    break;
-                case ']':
-                    currentToken = RBRACK;
-                    break;
-                case ';':
-                    currentToken = SEMI;
-                    break;
-                case ',':
-                    currentToken = COMMA;
-                    break;
-                default:
-                    currentToken = ERROR;
-                    break;
-                }
-            }
-            break;
-
-        case IN_ASSIGN: // ASSIGN으로 시작하는데 equal인지 assign인지 구분
-            state = DONE;
-            if (c == '=') // '==' 즉, eqaul이므로 TOKEN은 EQ
-                currentToken = EQ;
-            else { // '=' 하나이므로 ASSIGN 토큰
-                currentToken = ASSIGN;
-                ungetNextChar();
-            }
+            comp->srcPos = skipBlanks(comp, comp->srcPos, comp->lineEnd);
             break;
         case IN_COMMENT:
-            save = FALSE;
-            if (c == '*') {
-                c = getNextChar();
-                if (c == '/') { // '*/' 로 Comment 닫음.
-                    state = START;
-                }
-                else if (c == EOF) { // IN_COMMENT안에서  '*'에서 '/' 없이 파일을 다 읽었다면
-                    state = DONE;
-                    currentToken = STOP_BEFORE_END;
-                }
-                /* backup in the input */
-                else { //버퍼위치를 다시 직전으로 되돌려 그 값으로 처리할 수 있게 함.
-                    ungetNextChar();
-                }
-            }
-            else if (c == EOF) { // IN_COMMENT 상태에서 EOF가 되면,
-                state = DONE;
-                currentToken = STOP_BEFORE_END;
-            }
-            break;
-
-        case IN_NUM:
-            if (!isdigit(c)) { /* backup in the input */
-                ungetNextChar();
-                save = FALSE;
-                state = DONE;
-                currentToken = NUM;
-            }
-            break;
-
-        case IN_ID:                             /* backup in the input */
-            if (!(isalpha(c))) { //  IN_ID state에서는 letter letter* 을 받는다.
-                ungetNextChar();
-                save = FALSE;
-                state = DONE;
-                currentToken = ID;
-            }
+            comp->srcPos = findStar(comp, comp->srcPos, comp->lineEnd);
             break;
-
-        case IN_LT: // LT로 시작하는데 '<='인지 '<' 인지 구분
-            state = DONE;
-            if (c == '=') // '<='
-                currentToken = LTE;
-            else { // '<'
-                currentToken = LT;
-                ungetNextChar();
-            }
-            break;
-
-        case IN_GT: // GT로 시작하는데 '>='인지 '>' 인지 구분
-            state = DONE;
-            if (c == '=') // '>='
-                currentToken = GTE;
-            else { // '>'
-                currentToken = GT;
-                ungetNextChar();
-            }
-            break;
-
-        case IN_NE: // !로 시작하는데 '!='가 아니라면 ERROR
-            state = DONE;
-            if (c == '=') // NOT EQUAL(!=)
-                currentToken = NE;
-            else if (c == '/') {
-                c = lineBuf[linepos - 2]; // c= '!'
-                currentToken = ERROR;
-                ungetNextChar();
-            }
-            else { // ERROR
-                currentToken = ERROR;
-                ungetNextChar();
-            }
+        case IN_ID:
+            comp->srcPos = spanLetters(comp, comp->srcPos, comp->lineEnd);
             break;
-
-            /*comments cannot be placed within tokens) and may include than one
-            line. Comments may not be nested.*/
-        case IN_OVER: // OVER로 시작하는데 Comment인지 나누기인지 구분
-            if (c == '*') { // comment left '/*'
-                state = IN_COMMENT;
-                save = FALSE;
-            }
-            else { // '*'이 안나왔다면 OVER만, 즉 '/'를 표현 -> 나누기 기호
-                ungetNextChar();
-                state = DONE;
-                currentToken = OVER;
-            }
+        case IN_NUM:
+            value = addDigit(value, c);
+            comp->srcPos = spanNumber(comp, comp->srcPos, comp->lineEnd, &value);
             break;
-
-        case DONE:
-        default: /* should never happen */
-            fprintf(listing, "Scanner Bug: state= %d\n", state);
-            state = DONE;
-            currentToken = ERROR;
+        default:
             break;
         }
-        if ((save) && (tokenStringIndex <= MAXTOKENLEN))
-            tokenString[tokenStringIndex++] = (char)c;
-        if (state == DONE) {
-            tokenString[tokenStringIndex] = '\0';
-            if (currentToken == ID)
-                currentToken = reservedLookup(tokenString);
-        }
     }
-    if (TraceScan) {
-        fprintf(listing, "\t%d: ", lineno);
-        printToken(currentToken, tokenString);
+    /* the lexeme is srcBuf[tokStart, srcPos) */
+    if (currentToken == ENDFILE || currentToken == STOP_BEFORE_END) {
+        tokStart = comp->srcPos; // 파일 끝 위치
+        len = 0;
     }
-    return currentToken;
-} /* end getToken */
+    else
+        len = comp->srcPos - tokStart;
+    comp->tokenString = comp->srcBuf + tokStart;
+    comp->tokenOffset = tokStart;
+    comp->tokenLength = len;
+    comp->tokenValue = (currentToken == NUM) ? value : 0;
+    if (currentToken == ID)
+        currentToken = reservedLookup(comp->srcBuf + tokStart, comp->srcPos - tokStart);
+    if (trace) {
+        outChar(comp, '\t');
+        outInt(comp, comp->lineno, 0);
+        outText(comp, ": ");
+        printToken(comp, currentToken, comp->tokenString, comp->tokenLength);
+    }
+    return currentToken;
+} /* end scanToken */
+
+/* getTokenQuiet is getToken with EchoSource and TraceScan off,
+   for callers that never echo or trace */
+TokenType getTokenQuiet(Compiler* comp)
+{
+    return scanToken(comp, FALSE, FALSE);
+}
+
+/* getToken returns the next token, echoing and tracing as
+   EchoSource and TraceScan say. The flags are looked at once a
+   token, never inside the scanning loop */
+TokenType getToken(Compiler* comp)
+{
+#ifdef NOTRACE
+    return getTokenQuiet(comp);
+#else
+    if (comp->EchoSource)
+        return comp->TraceScan ? scanToken(comp, TRUE, TRUE) : scanToken(comp, TRUE, FALSE);
+    return comp->TraceScan ? scanToken(comp, FALSE, TRUE) : getTokenQuiet(comp);
+#endif
+}
+
+/* growTokens makes room for at least one more token in tb.
+   returns FALSE when out of memory */
+static int growTokens(Compiler* comp, TokenBuffer* tb)
+{
+    int cap = (tb->capacity == 0) ? 1024 : tb->capacity * 2;
+    unsigned char* kind = (unsigned char*)realloc(tb->kind, cap * sizeof(unsigned char));
+    size_t* offset = (size_t*)realloc(tb->offset, cap * sizeof(size_t));
+    int* length = (int*)realloc(tb->length, cap * sizeof(int));
+    int* name = (int*)realloc(tb->name, cap * sizeof(int));
+    int* value = (int*)realloc(tb->value, cap * sizeof(int));
+    if (kind != NULL) tb->kind = kind;
+    if (offset != NULL) tb->offset = offset;
+    if (length != NULL) tb->length = length;
+    if (name != NULL) tb->name = name;
+    if (value != NULL) tb->value = value;
+    if (kind == NULL || offset == NULL || length == NULL || name == NULL || value == NULL) {
+        outText(comp, "Out of memory error at line ");
+        outInt(comp, comp->lineno, 0);
+        outChar(comp, '\n');
+        return FALSE;
+    }
+    tb->capacity = cap;
+    return TRUE;
+}
+
+/* scanTokens appends up to maxTokens tokens (the rest of the
+   source if maxTokens <= 0) to tb, stopping after ENDFILE.
+   returns the number of tokens appended */
+int scanTokens(Compiler* comp, TokenBuffer* tb, int maxTokens)
+{
+    int n = 0;
+    TokenType tok;
+    do {
+        if (tb->count == tb->capacity && !growTokens(comp, tb))
+            break;
+        tok = getToken(comp);
+        tb->kind[tb->count] = (unsigned char)tok;
+        tb->offset[tb->count] = comp->tokenOffset;
+        tb->length[tb->count] = (int)comp->tokenLength;
+        tb->name[tb->count] = (tok == ID) ? internName(comp, comp->tokenString, (int)comp->tokenLength) : -1;
+        tb->value[tb->count] = comp->tokenValue;
+        tb->count++;
+        n++;
+    } while (tok != ENDFILE && n != maxTokens);
+    return n;
+}
+
+/* freeTokens releases the arrays of tb */
+void freeTokens(TokenBuffer* tb)
+{
+    free(tb->kind);
+    free(tb->offset);
+    free(tb->length);
+    free(tb->name);
+    free(tb->value);
+    tb->kind = NULL;
+    tb->offset = NULL;
+    tb->length = NULL;
+    tb->name = NULL;
+    tb->value = NULL;
+    tb->count = tb->capacity = 0;
+}
 
 
 ////////////////////////////////////////////////// PARSE.C 파일 ///////////////////////////////////////////
 
 
-static TokenType token; /* holds current token */
+/* nextToken hands out the next token of the batch, scanning
+   the next TOKENCHUNK tokens once the batch is used up.
+   tokenOffset, tokenString, tokenName (for IDs) and tokenValue
+   (for NUMs) are set;
+   tokenString is a view of the source buffer, not a copy */
+static TokenType nextToken(Compiler* comp)
+{
+    TokenType t;
+    if (comp->tokenIndex == comp->tokens.count) {
+        comp->tokens.count = 0;
+        comp->tokenIndex = 0;
+        if (scanTokens(comp, &comp->tokens, TOKENCHUNK) == 0) {
+            comp->tokenOffset = comp->srcLen;
+            comp->tokenLength = 0;
+            return ENDFILE;
+        }
+    }
+    t = (TokenType)comp->tokens.kind[comp->tokenIndex];
+    comp->tokenOffset = comp->tokens.offset[comp->tokenIndex];
+    comp->tokenLength = comp->tokens.length[comp->tokenIndex];
+    comp->tokenName = comp->tokens.name[comp->tokenIndex];
+    comp->tokenValue = comp->tokens.value[comp->tokenIndex];
+    comp->tokenString = comp->srcBuf + comp->tokenOffset;
+    if (t != ENDFILE) // ENDFILE 이후에는 계속 ENDFILE
+        comp->tokenIndex++;
+    return t;
+}
+
+/* currentName returns the pool entry of the current token's
+   text; tokens other than ID (after a syntax error) are interned
+   here, so every name in the tree has a handle */
+static Lexeme currentName(Compiler* comp)
+{
+    int id = (comp->token == ID) ? comp->tokenName : internName(comp, comp->tokenString, (int)comp->tokenLength);
+    return nameOf(comp, id);
+}
 
 /* function prototypes for recursive calls */
 
 // Syntax and Semantics of C-
 
-static TreeNode* declaration_list(void);
-static TreeNode* declaration(void);
-static TreeNode* var_declaration(void);
-static ExpType type_specifier(void); // type을 표현해야 함. 따라서, 자료형 ExpType로!   // 반환할 토큰은 int or void
-static TreeNode* fun_declaration(void);
-static TreeNode* params(void);
-static TreeNode* param_list(ExpType type);
-static TreeNode* param(ExpType type);
-static TreeNode* compound_stmt(void);
-static TreeNode* local_declarations(void);
-static TreeNode* statement_list(void);
-static TreeNode* statement(void);
-static TreeNode* expression_stmt(void);
-static TreeNode* selection_stmt(void);
-static TreeNode* iteration_stmt(void);
-static TreeNode* return_stmt(void);
-static TreeNode* expression(void);
-static TreeNode* simple_expression(TreeNode* g);
-static TreeNode* additive_expression(TreeNode* g);
-static TreeNode* term(TreeNode* g);
-static TreeNode* factor(TreeNode* g);
-static TreeNode* call(void);
-static TreeNode* args(void);
-static TreeNode* arg_list(void);
-static TreeNode* parse1(void);
-
-static void syntaxError(char* message)
-{
-    fprintf(listing, "\n>>> ");
-    fprintf(listing, "Syntax error at line %d: %s", lineno, message);
-    Error = TRUE;
-}
-
-static void match(TokenType expected)
-{
-    if (token == RPAREN && RPARENcheck == 1) {
-        fprintf(listing, "\n-- 해당 에러 구문 recovery :: 이어서 syntax tree 구성시작 --\n");
-        Error = FALSE;
-        RPARENcheck = 0;
-        token = getToken();
-        TreeNode* syntaxTree = parse1();
-        if (TraceParse) {
-            fprintf(listing, "\n***** \npossibility that it is a grammatical error in the main function. \n");
-            fprintf(listing, "Error handling for this is an exception and has not been processed yet. Check code again \n***** \n");
-            fprintf(listing, "\n Syntax tree:\n");
-            printTree(syntaxTree);
+static TreeNode* declaration_list(Compiler* comp);
+static TreeNode* declaration(Compiler* comp);
+static TreeNode* var_declaration(Compiler* comp);
+static ExpType type_specifier(Compiler* comp); // type을 표현해야 함. 따라서, 자료형 ExpType로!   // 반환할 토큰은 int or void
+static TreeNode* fun_declaration(Compiler* comp);
+static TreeNode* params(Compiler* comp);
+static TreeNode* param_list(Compiler* comp, ExpType type);
+static TreeNode* param(Compiler* comp, ExpType type);
+static TreeNode* compound_stmt(Compiler* comp);
+static TreeNode* local_declarations(Compiler* comp);
+static TreeNode* statement_list(Compiler* comp);
+static TreeNode* statement(Compiler* comp);
+static TreeNode* expression_stmt(Compiler* comp);
+static TreeNode* selection_stmt(Compiler* comp);
+static TreeNode* iteration_stmt(Compiler* comp);
+static TreeNode* return_stmt(Compiler* comp);
+static TreeNode* expression(Compiler* comp);
+static TreeNode* binary(Compiler* comp, TreeNode* t, int minPower);
+static TreeNode* factor(Compiler* comp);
+static TreeNode* call(Compiler* comp);
+static TreeNode* args(Compiler* comp);
+static TreeNode* arg_list(Compiler* comp);
+
+static void syntaxError(Compiler* comp, char* message)
+{
+    outText(comp, "\n>>> ");
+    outText(comp, "Syntax error at line ");
+    outInt(comp, lineOf(comp, comp->tokenOffset), 0);
+    outText(comp, ": ");
+    outText(comp, message);
+    comp->Error = TRUE;
+}
+
+/* Error recovery is panic mode. The first unexpected token puts the
+   parser in panic: further unexpected tokens are not reported, so
+   one mistake gives one message. Panic ends when match accepts a
+   token again, or when a list of statements or declarations skips
+   ahead to a synchronizing token (recoverStatement,
+   recoverDeclaration). Parsing always goes on to the end of the
+   file, so every error is reported in one pass */
+
+/* STMTSYNC is the set of tokens a broken statement is skipped to */
+#define SYNC(t) (1u << (t))
+#define STMTSYNC (SYNC(SEMI) | SYNC(RBRACE) | SYNC(LBRACE) | SYNC(IF) | SYNC(WHILE) \
+    | SYNC(RETURN) | SYNC(INT) | SYNC(VOID) | SYNC(ENDFILE))
+
+/* unexpected reports the current token as a syntax error,
+   unless the parser is already in panic */
+static void unexpected(Compiler* comp, char* message)
+{
+    if (comp->panic)
+        return;
+    syntaxError(comp, message);
+    printToken(comp, comp->token, comp->tokenString, comp->tokenLength);
+    comp->panic = TRUE;
+}
+
+/* recoverStatement skips to the next token in STMTSYNC; a SEMI
+   found there ends the broken statement and is skipped too */
+static void recoverStatement(Compiler* comp)
+{
+    while (!(STMTSYNC & SYNC(comp->token)))
+        comp->token = nextToken(comp);
+    if (comp->token == SEMI)
+        comp->token = nextToken(comp);
+    comp->panic = FALSE;
+}
+
+/* recoverDeclaration skips to the next INT or VOID outside of
+   parentheses and braces, so the parameters and the body of a
+   broken function are skipped whole instead of being read as
+   declarations of their own */
+static void recoverDeclaration(Compiler* comp)
+{
+    int parens = 0, braces = 0;
+    while (comp->token != ENDFILE) {
+        if ((comp->token == INT || comp->token == VOID) && parens == 0 && braces == 0)
+            break;
+        if (comp->token == LPAREN)
+            parens++;
+        else if (comp->token == RPAREN && parens > 0)
+            parens--;
+        else if (comp->token == LBRACE || comp->token == RBRACE || comp->token == SEMI) {
+            if (comp->token == LBRACE) braces++;
+            else if (comp->token == RBRACE && braces > 0) braces--;
+            parens = 0; // 닫히지 않은 '(' 는 여기까지
         }
-        fclose(source);
-        fclose(listing);
-        exit(1);
+        comp->token = nextToken(comp);
     }
+    comp->panic = FALSE;
+}
 
-    if (token == expected) token = getToken();
-    else {
-        syntaxError("unexpected token (match함수) -> ");
-        printToken(token, tokenString);
-        if (strcmp(tokenString, ")") == 0) {
-            paramcheck = 0;
-        }
-        fprintf(listing, "      ");
+static void match(Compiler* comp, TokenType expected)
+{
+    if (comp->token == expected) {
+        comp->token = nextToken(comp);
+        comp->panic = FALSE;
+    }
+    else if (!comp->panic) {
+        unexpected(comp, "unexpected token (match함수) -> ");
+        outText(comp, "      ");
     }
 }
 
-TreeNode* declaration_list(void)
+/* numberValue returns the value the scanner worked out for the
+   current NUM token; a NUM too large for an int is reported and
+   taken as INT_MAX. any other token is left for match to report */
+static int numberValue(Compiler* comp)
 {
-    TreeNode* t = declaration();
+    if (comp->token != NUM)
+        return 0;
+    if (comp->tokenValue < 0) {
+        syntaxError(comp, "integer constant too large -> ");
+        printToken(comp, comp->token, comp->tokenString, comp->tokenLength);
+        return INT_MAX;
+    }
+    return comp->tokenValue;
+}
+
+TreeNode* declaration_list(Compiler* comp)
+{
+    TreeNode* t = declaration(comp);
     TreeNode* p = t;
-    while (token != ENDFILE)
+    while (comp->token != ENDFILE)
     {
         TreeNode* q;
         // TINY에서는 stmt-sequence; statement l statement여서 match(SEMI)를 여기에 넣었지만,
         // C-에서는 그럴 필요 X
-        q = declaration();
+        if (comp->panic) {
+            recoverDeclaration(comp);
+            if (comp->token == ENDFILE)
+                break;
+        }
+        q = declaration(comp);
         if (q != NULL) {
             if (t == NULL) t = p = q;
             else /* now p cannot be NULL either */
@@ -712,148 +1516,142 @@ TreeNode* declaration_list(void)
 
 // declaration은 var-declration이나 fun-declaration을 호출한다.
 // var-declaration이나 fun-declaration은 둘 다 type-specifier ID까지 겹친다.
-TreeNode* declaration(void)
+TreeNode* declaration(Compiler* comp)
 {
     TreeNode* t = NULL;
-    ExpType temp_type = type_specifier();
-    char* val_or_fun_name = copyString(tokenString);
+    ExpType temp_type = type_specifier(comp);
+    Lexeme val_or_fun_name = currentName(comp);
 
-    match(ID);
+    match(comp, ID);
 
-    switch (token)
+    switch (comp->token)
     {
     case SEMI:
         // var-declaration -> type-specifier ID; 인 경우
-        t = newExpNode(checkVarK);
+        t = newExpNode(comp, checkVarK);
         if (t != NULL)
         {
             t->attr.name = val_or_fun_name;
             t->type = temp_type;
         }
-        match(SEMI);
+        match(comp, SEMI);
         break;
 
         // var-declaration -> type-specifier ID [ NUM ]; 인 경우
     case LBRACK: // '['
-        t = newExpNode(checkArrayVarK);
+        t = newExpNode(comp, checkArrayVarK);
         if (t != NULL)
         {
             t->attr.name = val_or_fun_name;
             t->type = temp_type;
         }
-        match(LBRACK); // '['
+        match(comp, LBRACK); // '['
         if (t != NULL)
-            t->array_size = atoi(tokenString);
-        match(NUM); // NUM 받고
-        match(RBRACK); // ']'
-        match(SEMI); // ';'
+            t->array_size = numberValue(comp);
+        match(comp, NUM); // NUM 받고
+        match(comp, RBRACK); // ']'
+        match(comp, SEMI); // ';'
         break;
 
         // fun-declaration -> type-specifier ID ( params ) compund-stmt 인 경우
     case LPAREN: // '('
 
-        t = newExpNode(fun_declarationK);
+        t = newExpNode(comp, fun_declarationK);
         if (t != NULL)
         {
             t->attr.name = val_or_fun_name;
             t->type = temp_type;
         }
-        match(LPAREN); // '('
+        match(comp, LPAREN); // '('
         if (t != NULL)
-            t->child[0] = params();
-        match(RPAREN); // ')'
+            t->child[0] = params(comp);
+        match(comp, RPAREN); // ')'
 
         if (t != NULL)
-            t->child[1] = compound_stmt();
+            t->child[1] = compound_stmt(comp);
         break;
-    default: syntaxError("unexpected token(decl함수) -> ");
-        printToken(token, tokenString);
-        token = getToken();
+    default: unexpected(comp, "unexpected token(decl함수) -> ");
+        comp->token = nextToken(comp);
         break;
     }
     return t;
 }
 
-TreeNode* var_declaration(void)
+TreeNode* var_declaration(Compiler* comp)
 {
     TreeNode* t = NULL;
 
-    ExpType temp_type = type_specifier();;
-    char* val_or_fun_name = copyString(tokenString);
+    ExpType temp_type = type_specifier(comp);;
+    Lexeme val_or_fun_name = currentName(comp);
 
-    match(ID);
+    match(comp, ID);
 
-    switch (token)
+    switch (comp->token)
     {
     case SEMI:
-        t = newExpNode(checkVarK);
+        t = newExpNode(comp, checkVarK);
         if (t != NULL)
         {
             t->attr.name = val_or_fun_name;
             t->type = temp_type;
         }
-        match(SEMI);
+        match(comp, SEMI);
         break;
     case LBRACK:
-        t = newExpNode(checkArrayVarK);
+        t = newExpNode(comp, checkArrayVarK);
         if (t != NULL)
         {
             t->attr.name = val_or_fun_name;
             t->type = temp_type;
         }
-        match(LBRACK);
+        match(comp, LBRACK);
         if (t != NULL)
-            t->array_size = atoi(tokenString);
-        match(NUM);
-        match(RBRACK);
-        match(SEMI);
+            t->array_size = numberValue(comp);
+        match(comp, NUM);
+        match(comp, RBRACK);
+        match(comp, SEMI);
         break;
-    default: syntaxError("unexpected token (var_decl함수) -> ");
-        printToken(token, tokenString);
-        if (token == RPAREN) {
-            RPARENcheck = 1;
-        }
-        token = getToken();
+    default: unexpected(comp, "unexpected token (var_decl함수) -> ");
+        comp->token = nextToken(comp);
         break;
     }
     return t;
 }
 
 
-TreeNode* fun_declaration(void)
+TreeNode* fun_declaration(Compiler* comp)
 {
     TreeNode* t = NULL;
 
-    ExpType temp_type = type_specifier();;
-    char* val_or_fun_name = copyString(tokenString);
+    ExpType temp_type = type_specifier(comp);;
+    Lexeme val_or_fun_name = currentName(comp);
 
-    match(ID);
+    match(comp, ID);
 
-    switch (token)
+    switch (comp->token)
     {
     case LPAREN: // '('
-        t = newExpNode(fun_declarationK);
+        t = newExpNode(comp, fun_declarationK);
         if (t != NULL)
         {
             t->attr.name = val_or_fun_name;
             t->type = temp_type;
         }
-        match(LPAREN); // '('
+        match(comp, LPAREN); // '('
         if (t != NULL)
-            t->child[0] = params();
-        match(RPAREN); // ')'
+            t->child[0] = params(comp);
+        match(comp, RPAREN); // ')'
         if (t != NULL)
-            t->child[1] = compound_stmt();
+            t->child[1] = compound_stmt(comp);
         break;
-    default: syntaxError("unexpected token(func함수) -> ");
-        printToken(token, tokenString);
-        token = getToken();
+    default: unexpected(comp, "unexpected token(func함수) -> ");
+        comp->token = nextToken(comp);
         break;
     }
     return t;
 }
 
-ExpType type_specifier(void)
+ExpType type_specifier(Compiler* comp)
 {
     /*
     // reserved words
@@ -866,18 +1664,16 @@ ExpType type_specifier(void)
        에 의해 switch문 token은 INT와 VOID로 구분.
        리턴 시에는 Integer, Void 로 한다.
     */
-    switch (token)
+    switch (comp->token)
     {
     case INT:
-        token = getToken();
+        comp->token = nextToken(comp);
         return Integer;
     case VOID:
-        token = getToken();
+        comp->token = nextToken(comp);
         return Void;
-    default: syntaxError("unexpected token(type함수) -> ");
-        paramcheck = 1;
-        printToken(token, tokenString);
-        token = getToken();
+    default: unexpected(comp, "unexpected token(type함수) -> ");
+        comp->token = nextToken(comp);
         return Void;
     }
 }
@@ -898,37 +1694,37 @@ and each invocation of a fiinction has a separate set of parameters.
 Functions may be recursive(to the extent that declaration before use allows).
 */
 
-TreeNode* params(void)
+TreeNode* params(Compiler* comp)
 {
     TreeNode* t = NULL;
-    ExpType temp_type = type_specifier();
+    ExpType temp_type = type_specifier(comp);
 
     // params -> void 인 경우
-    if (temp_type == Void && token == RPAREN) {
-        t = newExpNode(checkVarK);
+    if (temp_type == Void && comp->token == RPAREN) {
+        t = newExpNode(comp, checkVarK);
         t->include_param = 1;
         t->type = Void;
-        t->attr.name = "empty"; // 파라미터에 name 없이 type만 있을 경우 "empty"로 표시
+        t->attr.name = nameOf(comp, internName(comp, "empty", 5)); // 파라미터에 name 없이 type만 있을 경우 "empty"로 표시
     }
     // params -> param-list 인 경우
     else
-        t = param_list(temp_type);
+        t = param_list(comp, temp_type);
     return t;
 }
 
 // param_list는 EBNF로 했을 때
 // param_list -> param { , param } 이 된다.
 // 따라서, param_list는 param 먼저 호출
-TreeNode* param_list(ExpType type)
+TreeNode* param_list(Compiler* comp, ExpType type)
 {
-    TreeNode* t = param(type);
+    TreeNode* t = param(comp, type);
     TreeNode* p = t;
     TreeNode* q;
 
     // while문을 통해 { , param } 반복 표현
-    while (token == COMMA) {
-        match(COMMA); // ','
-        q = param(type_specifier());
+    while (comp->token == COMMA) {
+        match(comp, COMMA); // ','
+        q = param(comp, type_specifier(comp));
         if (q != NULL) {
             if (t == NULL) t = p = q;
             else /* now p cannot be NULL either */
@@ -945,22 +1741,21 @@ TreeNode* param_list(ExpType type)
 // param -> type-soecifier ID [ [ ] ] 이므로
 // type-specifier와 ID 매치를 해주고 [ ] 여부 판단
 
-TreeNode* param(ExpType type)
+TreeNode* param(Compiler* comp, ExpType type)
 {
     TreeNode* t = NULL;
-    char* val_or_fun_name;
+    Lexeme val_or_fun_name = currentName(comp);
 
-    val_or_fun_name = copyString(tokenString);
-    match(ID);
+    match(comp, ID);
 
-    if (token == LBRACK)
+    if (comp->token == LBRACK)
     {
-        match(LBRACK);
-        match(RBRACK);
-        t = newExpNode(checkArrayVarK);
+        match(comp, LBRACK);
+        match(comp, RBRACK);
+        t = newExpNode(comp, checkArrayVarK);
     }
     else
-        t = newExpNode(checkVarK);
+        t = newExpNode(comp, checkVarK);
     if (t != NULL)
     {
         t->attr.name = val_or_fun_name;
@@ -971,35 +1766,39 @@ TreeNode* param(ExpType type)
 }
 
 // compoind_stmt -> { local-declarations statement-list }
-TreeNode* compound_stmt(void)
+TreeNode* compound_stmt(Compiler* comp)
 {
 
-    TreeNode* t = newStmtNode(compound_stmtK);
+    TreeNode* t = newStmtNode(comp, compound_stmtK);
 
-    match(LBRACE);
+    match(comp, LBRACE);
 
-    t->child[0] = local_declarations();
-    t->child[1] = statement_list();
-    match(RBRACE);
+    t->child[0] = local_declarations(comp);
+    t->child[1] = statement_list(comp);
+    match(comp, RBRACE);
     return t;
 }
 
 // local - declarations-> local-declarations var-declaration ㅣ empty 는 EBNF로
 // local - declarations-> empty { var-declaration } 이므로 NULL처리 먼저.
-TreeNode* local_declarations(void)
+TreeNode* local_declarations(Compiler* comp)
 {
     TreeNode* t = NULL;
     TreeNode* p;
 
-    if (token == INT || token == VOID) {
-        t = var_declaration();
+    if (comp->token == INT || comp->token == VOID) {
+        t = var_declaration(comp);
     }
     p = t;
 
     if (t != NULL)
     {
-        while (token == INT || token == VOID) {
-            TreeNode* q = var_declaration();
+        for (;;) {
+            TreeNode* q;
+            if (comp->panic) recoverStatement(comp);
+            if (comp->token != INT && comp->token != VOID)
+                break;
+            q = var_declaration(comp);
             if (q != NULL) {
                 if (t == NULL) t = p = q;
                 else /* now p cannot be NULL either */
@@ -1015,18 +1814,24 @@ TreeNode* local_declarations(void)
 
 // statement-list -> statement-list statement ㅣ empty
 // EBNF로 statement-list -> empty { statement }
-TreeNode* statement_list(void)
+TreeNode* statement_list(Compiler* comp)
 {
-    if (token == RBRACE) { // ' } '
+    if (comp->token == RBRACE) { // ' } '
         return NULL;
     }
 
-    TreeNode* t = statement();
+    TreeNode* t = statement(comp);
     TreeNode* p = t;
 
-    while (token != RBRACE) // ' } '
+    while (comp->token != RBRACE && comp->token != ENDFILE) // ' } '
     {
-        TreeNode* q = statement();
+        TreeNode* q;
+        if (comp->panic) {
+            recoverStatement(comp);
+            if (comp->token == RBRACE || comp->token == ENDFILE)
+                break;
+        }
+        q = statement(comp);
         if (q != NULL) {
             if (t == NULL) t = p = q;
             else /* now p cannot be NULL either */
@@ -1039,23 +1844,12 @@ TreeNode* statement_list(void)
     return t;
 }
 
-//////////////////////////////
-TreeNode* parse1()
-{
-    TreeNode* t;
-    t = declaration_list();
-    if (token != ENDFILE)
-        syntaxError("Code ends before file\n");
-    return t;
-}
-/////////////////////////////////
-
 // statement -> expression-stmt ㅣ compound-stmt l selection-stmt
 //              ㅣ iteration-stmt ㅣ return-stmt
-TreeNode* statement(void)
+TreeNode* statement(Compiler* comp)
 {
     TreeNode* t = NULL;
-    switch (token)
+    switch (comp->token)
     {
         /*
         An expression statement has an optional expression followed by a semicolon.
@@ -1066,13 +1860,13 @@ TreeNode* statement(void)
     case LPAREN:
     case NUM:
     case SEMI:
-        t = expression_stmt();
+        t = expression_stmt(comp);
         break;
 
         // compound문 즉, 복합문은 선언 집합을 둘러싼 중괄호로 구성됨.
         // 복합 명령문은 주어진 순서대로 명령문 sequence를 실행
     case LBRACE: // ' { '
-        t = compound_stmt();
+        t = compound_stmt(comp);
         break;
 
         /*
@@ -1084,7 +1878,7 @@ TreeNode* statement(void)
         substructure of the current if (the “most closely nested” disambiguating rule).
         */
     case IF: // reserved words = IF
-        t = selection_stmt();
+        t = selection_stmt(comp);
         break;
 
         /*
@@ -1094,7 +1888,7 @@ TreeNode* statement(void)
          ending when the expression evaluates to 0.
         */
     case WHILE: // reserved words = WHILE
-        t = iteration_stmt();
+        t = iteration_stmt(comp);
         break;
 
         /*
@@ -1103,41 +1897,30 @@ TreeNode* statement(void)
          Functions declared void must not return values.
         */
     case RETURN: // reserved words = RETURN
-        t = return_stmt();
+        t = return_stmt(comp);
         break;
-    default: syntaxError("unexpected token(state함수) -> ");
-        printToken(token, tokenString);
-        if ((token == INT && paramcheck == 0) || token == VOID) { // int ((x<y) of int (x<y)) 와 같은 error 처리 부분
-            fprintf(listing, "\n-- 해당 에러 구문 recovery :: 이어서 syntax tree 구성시작 --\n");
-            Error = FALSE;
-            TreeNode* syntaxTree = parse1();
-            if (TraceParse) {
-                fprintf(listing, "\nSyntax tree:\n");
-                printTree(syntaxTree);
-            }
-            fclose(source);
-            fclose(listing);
-
-            exit(1);
-        }
-        token = getToken();
-        return Void;
+    default: unexpected(comp, "unexpected token(state함수) -> ");
+        if (comp->token == INT || comp->token == VOID) // 문장 사이의 선언은 읽고 버림
+            declaration(comp);
+        else if (comp->token != RBRACE && comp->token != ENDFILE) // 블록 끝은 compound-stmt에 남김
+            comp->token = nextToken(comp);
+        return NULL;
     }
     return t;
 }
 
 // expression_stmt() -> expression ; ㅣ ;
-TreeNode* expression_stmt(void)
+TreeNode* expression_stmt(Compiler* comp)
 {
     TreeNode* t = NULL;
 
-    if (token == SEMI) {
-        match(SEMI);
+    if (comp->token == SEMI) {
+        match(comp, SEMI);
     }
-    else if (token != RBRACE)
+    else if (comp->token != RBRACE)
     {
-        t = expression();
-        match(SEMI);
+        t = expression(comp);
+        match(comp, SEMI);
     }
     return t;
 }
@@ -1146,44 +1929,44 @@ TreeNode* expression_stmt(void)
 selection-stmt -> if ( expression ) statement ㅣ if ( expression )                              statement else statement
 EBNF 변경 => selection-stmt -> if ( expression ) statement [ else statement ]
 */
-TreeNode* selection_stmt(void)
+TreeNode* selection_stmt(Compiler* comp)
 {
-    TreeNode* t = newStmtNode(selection_stmtK);
+    TreeNode* t = newStmtNode(comp, selection_stmtK);
 
-    match(IF); // ' IF '
-    match(LPAREN); // ' ( '
+    match(comp, IF); // ' IF '
+    match(comp, LPAREN); // ' ( '
 
     if (t != NULL) {
-        t->child[0] = expression();
+        t->child[0] = expression(comp);
     }
-    match(RPAREN); // ')'
+    match(comp, RPAREN); // ')'
     if (t != NULL) {
-        t->child[1] = statement();
+        t->child[1] = statement(comp);
     }
     // optional
-    if (token == ELSE) {
-        match(ELSE);
+    if (comp->token == ELSE) {
+        match(comp, ELSE);
         if (t != NULL)
-            t->child[2] = statement();
+            t->child[2] = statement(comp);
     }
     return t;
 }
 
 // iteration-stmt -> while (expression) statement
-TreeNode* iteration_stmt(void)
+TreeNode* iteration_stmt(Compiler* comp)
 {
-    TreeNode* t = newStmtNode(iteration_stmtK);
+    TreeNode* t = newStmtNode(comp, iteration_stmtK);
 
-    match(WHILE);
+    match(comp, WHILE);
 
-    match(LPAREN); // '('
+    match(comp, LPAREN); // '('
 
     if (t != NULL)
-        t->child[0] = expression();
+        t->child[0] = expression(comp);
 
-    match(RPAREN); // ')'
+    match(comp, RPAREN); // ')'
     if (t != NULL)
-        t->child[1] = statement();
+        t->child[1] = statement(comp);
 
     return t;
 }
@@ -1192,209 +1975,178 @@ TreeNode* iteration_stmt(void)
  return-stmt -> return ; ㅣ return expression ; 를
 EBNF로 return-stmt -> return [ expression ] ;
 */
-TreeNode* return_stmt(void)
+TreeNode* return_stmt(Compiler* comp)
 {
-    TreeNode* t = newStmtNode(return_stmtK);
+    TreeNode* t = newStmtNode(comp, return_stmtK);
 
-    match(RETURN);
-    if (token != SEMI && t != NULL) {
-        t->child[0] = expression();
+    match(comp, RETURN);
+    if (comp->token != SEMI && t != NULL) {
+        t->child[0] = expression(comp);
     }
-    match(SEMI);
+    match(comp, SEMI);
     return t;
 }
 
+/* binding powers of the binary operators (see binary) */
+#define RELPOWER 1 /* relop: <= < > >= == !=, not associative */
+#define ADDPOWER 2 /* addop: + -, left associative */
+#define MULPOWER 3 /* mulop: * /, left associative */
+
+/* bindingPower is the power of each binary operator token, 0 for the rest */
+static const unsigned char bindingPower[STOP_BEFORE_END + 1] = {
+    [PLUS] = ADDPOWER, [MINUS] = ADDPOWER, [TIMES] = MULPOWER, [OVER] = MULPOWER,
+    [LT] = RELPOWER, [LTE] = RELPOWER, [GT] = RELPOWER, [GTE] = RELPOWER,
+    [EQ] = RELPOWER, [NE] = RELPOWER
+};
+
 /*
 expression -> var = expression ㅣ simple-expression
 */
-TreeNode* expression(void)
+TreeNode* expression(Compiler* comp)
 {
     TreeNode* t = NULL;
     TreeNode* q = NULL;
     int check = 0;
 
-    if (token == ID)
+    if (comp->token == ID)
     {
-        q = call();
+        q = call(comp);
         check = 1;
     }
 
-    if (check == 1 && token == ASSIGN)
+    if (check == 1 && comp->token == ASSIGN)
     {
         if (q != NULL && q->nodekind == ExpK && q->kind.exp == IdK)
         {
-            match(ASSIGN);
-            t = newExpNode(AssignK);
+            match(comp, ASSIGN);
+            t = newExpNode(comp, AssignK);
             if (t != NULL)
             {
                 t->child[0] = q;
-                t->child[1] = expression();
+                t->child[1] = expression(comp);
             }
         }
         else
         {
-            syntaxError("unexpected\n");
-            token = getToken();
+            unexpected(comp, "unexpected token(expr함수) -> "); // 변수가 아닌 것에 대입
+            comp->token = nextToken(comp);
+            expression(comp); // 오른쪽은 읽고 버림
         }
     }
     else
-        t = simple_expression(q);
+        t = binary(comp, (q != NULL) ? q : factor(comp), RELPOWER);
     return t;
 }
 
 /*
 simple-expression -> additive-expression relop additive-expression ㅣ additive-expression
-EBNF로 simple-expression -> additive-expression [ relop additive-expression ]
-*/
-TreeNode* simple_expression(TreeNode* g)
-{
-    TreeNode* t = NULL;
-    TreeNode* q = additive_expression(g);
-    // relop -> <= ㅣ < ㅣ > l >= l == l !=
-    // relop -> LTE ㅣ LT ㅣ GT ㅣ GTE ㅣ EQ ㅣ NE
-    if (token == LTE || token == LT || token == GT || token == GTE || token == EQ || token == NE)
-    {
-        TokenType temp_relop = token;
-        match(token);
-        t = newExpNode(OpK);
-
-        if (t != NULL) {
-            t->child[0] = q;
-            t->child[1] = additive_expression(NULL);
-            t->attr.op = temp_relop;
-        }
-    }
-    else
-        t = q;
-    return t;
-}
-
-/*
 additive-expression -> additive-expression addop term ㅣ term
-EBNF로 additive-expression -> term { addop term }
-*/
-TreeNode* additive_expression(TreeNode* g)
-{
-    TreeNode* t = term(g);
-    // addop -> +ㅣ-
-    if (t != NULL) {
-        while (token == PLUS || token == MINUS)
-        {
-            TreeNode* q = newExpNode(OpK);
-            if (q != NULL) {
-                q->child[0] = t;
-                q->attr.op = token;
-                t = q;
-
-                match(token);
-
-                t->child[1] = term(NULL);
-            }
-        }
-    }
-    return t;
-}
-
-/*
 term -> term mulop factor ㅣ factor
-EBNF로 term -> factor { mulop factor }
+These three are parsed by one precedence-climbing loop (binary)
+over the binding power of the operator tokens (see bindingPower).
 */
-TreeNode* term(TreeNode* g)
+/* binary parses the operators of power minPower and up that follow
+   the operand t and returns the expression; binary(t, RELPOWER) is a
+   simple-expression starting with t. The trees are the grammar's:
+   the right operand of an operator is parsed at the next power up,
+   so addop and mulop chains lean left, and nothing of the same power
+   follows a relop. limit is the highest power the grammar still
+   allows at this point: after an operator nothing of higher power
+   can follow (the right operand took it, unless it was missing),
+   and after a missing first operand only a relop can */
+TreeNode* binary(Compiler* comp, TreeNode* t, int minPower)
 {
-    TreeNode* t = factor(g);
-    // mulop -> * ㅣ /
-    if (t != NULL) {
-        while (token == TIMES || token == OVER)
-        {
-            TreeNode* q = newExpNode(OpK);
-            if (q != NULL) {
-                q->child[0] = t;
-                q->attr.op = token;
-                t = q;
-
-                match(token);
-
-                t->child[1] = factor(NULL);
-            }
+    int limit = (t == NULL) ? RELPOWER : MULPOWER;
+    int power;
+    while ((power = bindingPower[comp->token]) >= minPower && power <= limit)
+    {
+        TreeNode* q = newExpNode(comp, OpK);
+        TreeNode* right;
+        if (q != NULL) {
+            q->child[0] = t;
+            q->attr.op = comp->token;
+        }
+        match(comp, comp->token);
+        right = binary(comp, factor(comp), power + 1);
+        if (q != NULL) {
+            q->child[1] = right;
+            t = q;
         }
+        limit = (power == RELPOWER) ? RELPOWER - 1 : power;
     }
     return t;
 }
 
 // factor -> ( expression ) ㅣ var ㅣ call ㅣ NUM
 // var는 위에서 같이 처리
-TreeNode* factor(TreeNode* g)
+TreeNode* factor(Compiler* comp)
 {
-    if (g != NULL) {
-        return g;
-    }
-
     TreeNode* t = NULL;
-    switch (token)
+    switch (comp->token)
     {
     case LPAREN: // '('
-        match(LPAREN);
-        t = expression();
-        match(RPAREN); // ')'
+        match(comp, LPAREN);
+        t = expression(comp);
+        match(comp, RPAREN); // ')'
         break;
     case ID:
-        t = call();
+        t = call(comp);
         break;
     case NUM:
-        t = newExpNode(ConstK);
+        t = newExpNode(comp, ConstK);
         if (t != NULL)
         {
-            t->attr.val = atoi(tokenString);
+            t->attr.val = numberValue(comp);
             t->type = Integer;
         }
-        match(NUM);
+        match(comp, NUM);
         break;
-    default: syntaxError("unexpected token(fac함수) -> ");
-        printToken(token, tokenString);
-        token = getToken();
-        return Void;
+    default: unexpected(comp, "unexpected token(fac함수) -> ");
+        if (!(STMTSYNC & SYNC(comp->token))) // ';' 나 '}' 는 문장 쪽에서 처리
+            comp->token = nextToken(comp);
+        return NULL;
     }
     return t;
 }
 
 
 // call -> ID ( args )
-TreeNode* call(void)
+TreeNode* call(Compiler* comp)
 {
+    static const Lexeme noName = { "", 0, -1 }; /* after a syntax error */
     TreeNode* t;
-    char* val_or_fun_name = NULL;
+    Lexeme val_or_fun_name = noName;
 
-    if (token == ID) {
-        val_or_fun_name = copyString(tokenString);
-    }
-    match(ID);
+    if (comp->token == ID)
+        val_or_fun_name = nameOf(comp, comp->tokenName);
+    match(comp, ID);
 
-    if (token == LPAREN)
+    if (comp->token == LPAREN)
     {
-        match(LPAREN);
-        t = newStmtNode(callK);
+        match(comp, LPAREN);
+        t = newStmtNode(comp, callK);
         if (t != NULL)
         {
             t->attr.name = val_or_fun_name;
-            t->child[0] = args();
+            t->child[0] = args(comp);
         }
-        match(RPAREN);
+        match(comp, RPAREN);
     }
-    else if (token == LBRACK)
+    else if (comp->token == LBRACK)
     {
-        t = newExpNode(IdK);
+        t = newExpNode(comp, IdK);
         if (t != NULL)
         {
             t->attr.name = val_or_fun_name;
             t->type = Integer;
-            match(LBRACK);
-            t->child[0] = expression();
-            match(RBRACK);
+            match(comp, LBRACK);
+            t->child[0] = expression(comp);
+            match(comp, RBRACK);
         }
     }
     else
     {
-        t = newExpNode(IdK);
+        t = newExpNode(comp, IdK);
         if (t != NULL)
         {
             t->attr.name = val_or_fun_name;
@@ -1404,13 +2156,13 @@ TreeNode* call(void)
     return t;
 }
 
-TreeNode* args(void)
+TreeNode* args(Compiler* comp)
 {
-    if (token == RPAREN) {
+    if (comp->token == RPAREN) {
         return NULL;
     }
     else {
-        return arg_list();
+        return arg_list(comp);
     }
 }
 
@@ -1419,16 +2171,16 @@ arg-list -> arg-list , expression ㅣ expression
 EBNF로 arg-list -> arg-list { , expression }
 */
 
-TreeNode* arg_list(void)
+TreeNode* arg_list(Compiler* comp)
 {
-    TreeNode* t = expression();
+    TreeNode* t = expression(comp);
     TreeNode* p = t;
 
     if (t != NULL) {
-        while (token == COMMA)
+        while (comp->token == COMMA)
         {
-            match(COMMA);
-            TreeNode* q = expression();
+            match(comp, COMMA);
+            TreeNode* q = expression(comp);
             if (q != NULL) {
                 if (t == NULL) t = p = q;
                 else /* now p cannot be NULL either */
@@ -1448,59 +2200,1155 @@ TreeNode* arg_list(void)
 /* Function parse returns the newly
  * constructed syntax tree
  */
-TreeNode* parse()
+TreeNode* parse(Compiler* comp)
 {
     TreeNode* t;
-    token = getToken();
-    t = declaration_list();
-    if (token != ENDFILE)
-        syntaxError("Code ends before file\n");
+    comp->token = nextToken(comp);
+    t = declaration_list(comp);
+    if (comp->token != ENDFILE)
+        syntaxError(comp, "Code ends before file\n");
     return t;
 }
 
 
-///////////////////////////////////////////////////   MAIN.C 파일    //////////////////////////
-int main(int argc, char* argv[]) {
-    TreeNode* syntaxTree;
-    char PFile[120]; /* 스캔한 결과 출력대상 파일*/
-    char SFile[120]; /* source code file name */
-    if (argc != 3)
-    {
-        fprintf(stderr, "usage: %s <filename>\n", argv[0]);
-        exit(1);
+////////////////////////////////////////////////// AST.C 파일 ///////////////////////////////////////////
+/*
+Compact syntax tree. compactTree copies a TreeNode tree into an Ast:
+one node array in preorder (the order printTree visits the nodes),
+addressed by 32-bit indices, in struct-of-arrays form. Node i's
+subtree is [i, end[i]), so its children are the nodes from i + 1 on,
+each followed by the next at its end. The slot bits of flags say
+which child list (child[0..2]) of its parent a node was in, and
+value is a payload whose meaning depends on the kind:
+
+    callK, IdK, checkVarK, fun_declarationK   name pool handle
+    checkArrayVarK                            index in arrays
+    OpK                                       operator token
+    ConstK                                    value
+    other statements, AssignK                 0
+
+A node takes 18 bytes (plus 8 in arrays for array declarations)
+instead of sizeof(TreeNode). Nothing in an Ast is a pointer.
+*/
+
+/* AstKind is StmtKind for statements, ASTEXP + ExpKind for expressions */
+#define ASTEXP 8
+#define astKind(t) (((t)->nodekind == ExpK ? ASTEXP : 0) + ((t)->nodekind == ExpK ? (int)(t)->kind.exp : (int)(t)->kind.stmt))
+
+/* bits of Ast.flags */
+#define ASTSLOT 0x03 /* child list of the parent the node is in */
+#define ASTINT 0x04 /* type is Integer */
+#define ASTPARAM 0x08 /* include_param */
+#define ASTHAS(i) (0x10 << (i)) /* child[i] is not NULL */
+
+/* AstArray is the payload of an array declaration */
+typedef struct {
+    int name; /* name pool handle */
+    int size; /* array_size */
+} AstArray;
+
+typedef struct {
+    unsigned count; /* number of nodes */
+    unsigned capacity;
+    unsigned char* kind; /* AstKind */
+    unsigned char* flags;
+    unsigned* end; /* the subtree of node i is [i, end[i]) */
+    int* value; /* payload (see above) */
+    size_t* offset; /* source offset (see lineOf) */
+    AstArray* arrays;
+    unsigned arrayCount;
+    unsigned arrayCapacity;
+} Ast;
+
+/* growAst makes room for at least one more node in ast.
+   returns FALSE when out of memory */
+static int growAst(Ast* ast)
+{
+    unsigned cap = (ast->capacity == 0) ? 1024 : ast->capacity * 2;
+    unsigned char* kind = (unsigned char*)realloc(ast->kind, cap * sizeof(unsigned char));
+    unsigned char* flags = (unsigned char*)realloc(ast->flags, cap * sizeof(unsigned char));
+    unsigned* end = (unsigned*)realloc(ast->end, cap * sizeof(unsigned));
+    int* value = (int*)realloc(ast->value, cap * sizeof(int));
+    size_t* offset = (size_t*)realloc(ast->offset, cap * sizeof(size_t));
+    if (kind != NULL) ast->kind = kind;
+    if (flags != NULL) ast->flags = flags;
+    if (end != NULL) ast->end = end;
+    if (value != NULL) ast->value = value;
+    if (offset != NULL) ast->offset = offset;
+    if (kind == NULL || flags == NULL || end == NULL || value == NULL || offset == NULL)
+        return FALSE;
+    ast->capacity = cap;
+    return TRUE;
+}
+
+/* addArray appends an array payload to ast and returns its index,
+   or -1 when out of memory */
+static int addArray(Ast* ast, int name, int size)
+{
+    if (ast->arrayCount == ast->arrayCapacity) {
+        unsigned cap = (ast->arrayCapacity == 0) ? 64 : ast->arrayCapacity * 2;
+        AstArray* arrays = (AstArray*)realloc(ast->arrays, cap * sizeof(AstArray));
+        if (arrays == NULL)
+            return -1;
+        ast->arrays = arrays;
+        ast->arrayCapacity = cap;
     }
+    ast->arrays[ast->arrayCount].name = name;
+    ast->arrays[ast->arrayCount].size = size;
+    return (int)ast->arrayCount++;
+}
 
-    //source code file 처리작업
-    strcpy(SFile, argv[1]);
-    if (strchr(SFile, '.') == NULL)
-        strcat(SFile, ".c");
-    source = fopen(SFile, "r");
+/* addNode appends t (child list slot of its parent) to ast.
+   end is filled in once the subtree is done.
+   returns FALSE when out of memory */
+static int addNode(Ast* ast, const TreeNode* t, int slot)
+{
+    unsigned i = ast->count;
+    int kind = astKind(t);
+    int flags = slot;
+    int value = 0;
+    if (i == ast->capacity && !growAst(ast))
+        return FALSE;
+    for (int c = 0; c < MAXCHILDREN; c++)
+        if (t->child[c] != NULL) flags |= ASTHAS(c);
+    if (t->nodekind == ExpK) {
+        if (t->type == Integer) flags |= ASTINT;
+        if (t->include_param == 1) flags |= ASTPARAM;
+    }
+    switch (kind) {
+    case callK:
+    case ASTEXP + IdK:
+    case ASTEXP + checkVarK:
+    case ASTEXP + fun_declarationK:
+        value = t->attr.name.id;
+        break;
+    case ASTEXP + checkArrayVarK:
+        value = addArray(ast, t->attr.name.id, t->array_size);
+        if (value < 0)
+            return FALSE;
+        break;
+    case ASTEXP + OpK:
+        value = (int)t->attr.op;
+        break;
+    case ASTEXP + ConstK:
+        value = t->attr.val;
+        break;
+    default:
+        break;
+    }
+    ast->kind[i] = (unsigned char)kind;
+    ast->flags[i] = (unsigned char)flags;
+    ast->value[i] = value;
+    ast->offset[i] = t->offset;
+    ast->end[i] = i + 1;
+    ast->count++;
+    return TRUE;
+}
 
-    // 스캔한 결과 출력대상 file 처리작업
-    strcpy(PFile, argv[2]);
-    if (strchr(PFile, '.') == NULL)
-        strcat(PFile, ".txt");
-    listing = fopen(PFile, "w");
+/* AstFrame is a node of compactTree's path from the top level */
+typedef struct {
+    const TreeNode* node;
+    unsigned index; /* its index in the Ast */
+    int child; /* next child list to copy */
+} AstFrame;
+
+/* compactTree appends the tree (a sibling list) to ast. It keeps
+   its own stack, so the depth of the tree does not matter.
+   returns FALSE when out of memory */
+int compactTree(const TreeNode* tree, Ast* ast)
+{
+    AstFrame* stack = NULL;
+    int depth = 0, capacity = 0, slot = 0;
+    const TreeNode* t = tree;
+    for (;;) {
+        if (t != NULL) {
+            if (depth == capacity) {
+                int cap = (capacity == 0) ? 64 : capacity * 2;
+                AstFrame* grown = (AstFrame*)realloc(stack, cap * sizeof(AstFrame));
+                if (grown == NULL)
+                    break;
+                stack = grown;
+                capacity = cap;
+            }
+            if (!addNode(ast, t, slot))
+                break;
+            stack[depth].node = t;
+            stack[depth].index = ast->count - 1;
+            stack[depth].child = 0;
+            depth++;
+            t = NULL;
+        }
+        else if (depth == 0) {
+            free(stack);
+            return TRUE;
+        }
+        else {
+            AstFrame* top = &stack[depth - 1];
+            if (top->child < MAXCHILDREN) {
+                slot = top->child++;
+                t = top->node->child[slot];
+            }
+            else {
+                /* subtree done: go on with the next sibling */
+                ast->end[top->index] = ast->count;
+                slot = ast->flags[top->index] & ASTSLOT;
+                t = top->node->sibling;
+                depth--;
+            }
+        }
+    }
+    free(stack);
+    return FALSE;
+}
 
-    if (source == NULL)
+/* freeAst releases the arrays of ast */
+void freeAst(Ast* ast)
+{
+    free(ast->kind);
+    free(ast->flags);
+    free(ast->end);
+    free(ast->value);
+    free(ast->offset);
+    free(ast->arrays);
+    memset(ast, 0, sizeof(Ast));
+}
+
+/* astHasName is TRUE for the kinds whose value is a name pool handle */
+static int astHasName(int kind)
+{
+    return kind == callK || kind == ASTEXP + IdK || kind == ASTEXP + checkVarK
+        || kind == ASTEXP + fun_declarationK;
+}
+
+/* printAstNode prints one node the way printTree prints a TreeNode.
+   name is the node's name (the array's for checkArrayVarK) and value
+   is the array size, operator or constant */
+static void printAstNode(Compiler* comp, int kind, int flags, Lexeme name, int value)
+{
+    ExpType type = (flags & ASTINT) ? Integer : Void;
+    switch (kind) {
+    case compound_stmtK:
+        outText(comp, "Compound-stmt :\n");
+        break;
+    case selection_stmtK:
+        outText(comp, (flags & ASTHAS(2)) ? "If-stmt (else 포함) :\n" : "If-stmt (else 미포함) :\n");
+        break;
+    case iteration_stmtK:
+        outText(comp, "While-stmt (iteration) :\n");
+        break;
+    case return_stmtK:
+        outText(comp, (flags & ASTHAS(0)) ? "Return-stmt :\n" : "Return; \n");
+        break;
+    case callK:
+        outText(comp, "Call-stmt : ");
+        outChars(comp, name.str, name.len);
+        outText(comp, " \n");
+        break;
+    case ASTEXP + checkArrayVarK:
+        if (flags & ASTPARAM) {
+            printDecl(comp, "Parameter in Array", name, type);
+            outText(comp, " ] \n");
+        }
+        else {
+            printDecl(comp, "Declaration of Array", name, type);
+            outText(comp, ", (array_size : ");
+            outInt(comp, value, 0);
+            outText(comp, ") ]\n");
+        }
+        break;
+    case ASTEXP + checkVarK:
+        printDecl(comp, (flags & ASTPARAM) ? "Parameter variable" : "Declaration of variable", name, type);
+        outText(comp, " ]\n");
+        break;
+    case ASTEXP + fun_declarationK:
+        printDecl(comp, "func-declaration", name, type);
+        outText(comp, " ]\n");
+        break;
+    case ASTEXP + OpK:
+        outText(comp, "Op : ");
+        printToken(comp, (TokenType)value, "", 0);
+        break;
+    case ASTEXP + ConstK:
+        outText(comp, "Const: ");
+        outInt(comp, value, 0);
+        outChar(comp, '\n');
+        break;
+    case ASTEXP + IdK:
+        outText(comp, "Id : ");
+        outChars(comp, name.str, name.len);
+        outChar(comp, '\n');
+        break;
+    case ASTEXP + AssignK:
+        outText(comp, "Assign : (좌=우) \n");
+        break;
+    default:
+        outText(comp, "Unknown ExpNode kind\n");
+        break;
+    }
+}
+
+/* AstIndent follows the nesting depth of a preorder walk with a
+   stack of the ends of the subtrees around the current node */
+typedef struct {
+    unsigned* ends;
+    int depth;
+    int capacity;
+} AstIndent;
+
+/* indentAst indents node i, whose subtree is [i, end), and
+   returns FALSE (with a message) when out of memory */
+static int indentAst(Compiler* comp, AstIndent* in, unsigned i, unsigned end)
+{
+    while (in->depth > 0 && in->ends[in->depth - 1] <= i)
+        in->depth--;
+    outSpaces(comp, comp->indentno + 2 * (in->depth + 1));
+    if (end > i + 1) {
+        if (in->depth == in->capacity) {
+            int cap = (in->capacity == 0) ? 64 : in->capacity * 2;
+            unsigned* grown = (unsigned*)realloc(in->ends, cap * sizeof(unsigned));
+            if (grown == NULL) {
+                outText(comp, "Out of memory error\n");
+                return FALSE;
+            }
+            in->ends = grown;
+            in->capacity = cap;
+        }
+        in->ends[in->depth++] = end;
+    }
+    return TRUE;
+}
+
+/* printAst prints ast like printTree prints the tree it was made from */
+void printAst(Compiler* comp, const Ast* ast)
+{
+    AstIndent in = { 0 };
+    for (unsigned i = 0; i < ast->count; i++) {
+        int kind = ast->kind[i];
+        int value = ast->value[i];
+        Lexeme name = { "", 0, -1 };
+        if (!indentAst(comp, &in, i, ast->end[i]))
+            break;
+        if (kind == ASTEXP + checkArrayVarK) {
+            name = nameOf(comp, ast->arrays[value].name);
+            value = ast->arrays[value].size;
+        }
+        else if (astHasName(kind))
+            name = nameOf(comp, value);
+        printAstNode(comp, kind, ast->flags[i], name, value);
+    }
+    free(in.ends);
+}
+
+
+////////////////////////////////////////////////// ASTFILE.C 파일 ///////////////////////////////////////////
+/*
+Binary syntax tree files (parse -b), so that later tools load a tree
+without parsing the source again. The file is the compact tree of
+AST.C with lines in place of source offsets and the name pool
+attached. Layout, every number little-endian:
+
+    header   "CMAS", ASTVERSION, a byte of ASTERRORS, 2 zero bytes, then
+             32-bit counts of nodes, array payloads, names and name bytes
+    end      32 bits per node, the subtree of node i is [i, end[i])
+    value    32 bits per node (see AST.C; name handles index names,
+             -1 is the empty name as in nameOf)
+    line     32 bits per node, the source line it was made at
+    arrays   two 32-bit values per payload: name handle, array_size
+    names    32 bits per name plus one: name i is the bytes
+             [names[i], names[i + 1]) of the name bytes
+    kind     one byte per node (AstKind)
+    flags    one byte per node
+    bytes    the name bytes
+
+Nothing in the file is a pointer and the records have fixed sizes,
+so a reader maps it (mapSource) and reads node i in place through
+an AstFile, with no pass over the file when it is opened.
+*/
+
+#define ASTMAGIC "CMAS"
+#define ASTVERSION 1
+#define ASTHEADER 24 /* size of the file header in bytes */
+#define ASTERRORS 0x01 /* header bit: the source had syntax errors */
+
+/* putU32 stores v little-endian at p */
+static void putU32(unsigned char* p, unsigned v)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        p[i] = (unsigned char)(v >> (8 * i));
+}
+
+/* getU32 loads a little-endian 32-bit value from p */
+static unsigned getU32(const unsigned char* p)
+{
+    return (unsigned)p[0] | (unsigned)p[1] << 8 | (unsigned)p[2] << 16 | (unsigned)p[3] << 24;
+}
+
+/* AstWriter buffers the numbers of a syntax tree file */
+typedef struct {
+    FILE* fp;
+    unsigned char buf[4096];
+    size_t used;
+    int ok; /* FALSE once a write failed */
+} AstWriter;
+
+/* flushAst writes out the buffered bytes of w */
+static void flushAst(AstWriter* w)
+{
+    if (w->ok && w->used > 0)
+        w->ok = fwrite(w->buf, 1, w->used, w->fp) == w->used;
+    w->used = 0;
+}
+
+/* writeU32 appends v to w */
+static void writeU32(AstWriter* w, unsigned v)
+{
+    if (w->used == sizeof w->buf)
+        flushAst(w);
+    putU32(w->buf + w->used, v);
+    w->used += 4;
+}
+
+/* writeAstFile writes ast and the name pool to fp, marked with
+   ASTERRORS if Error is set; the source must still be mapped for
+   the lines. returns FALSE if it could not be written */
+int writeAstFile(Compiler* comp, const Ast* ast, FILE* fp)
+{
+    AstWriter w;
+    unsigned char header[ASTHEADER] = { 0 };
+    unsigned bytes = 0, k;
+    int id;
+    for (id = 0; id < comp->nameCount; id++)
+        bytes += (unsigned)nameOf(comp, id).len;
+    memcpy(header, ASTMAGIC, 4);
+    header[4] = ASTVERSION;
+    header[5] = comp->Error ? ASTERRORS : 0;
+    putU32(header + 8, ast->count);
+    putU32(header + 12, ast->arrayCount);
+    putU32(header + 16, (unsigned)comp->nameCount);
+    putU32(header + 20, bytes);
+    w.fp = fp;
+    w.used = 0;
+    w.ok = fwrite(header, 1, ASTHEADER, fp) == ASTHEADER;
+    for (k = 0; k < ast->count; k++)
+        writeU32(&w, ast->end[k]);
+    for (k = 0; k < ast->count; k++)
+        writeU32(&w, (unsigned)ast->value[k]);
+    for (k = 0; k < ast->count; k++)
+        writeU32(&w, (unsigned)lineOf(comp, ast->offset[k]));
+    for (k = 0; k < ast->arrayCount; k++) {
+        writeU32(&w, (unsigned)ast->arrays[k].name);
+        writeU32(&w, (unsigned)ast->arrays[k].size);
+    }
+    bytes = 0;
+    for (id = 0; id < comp->nameCount; id++) {
+        writeU32(&w, bytes);
+        bytes += (unsigned)nameOf(comp, id).len;
+    }
+    writeU32(&w, bytes);
+    flushAst(&w);
+    w.ok = w.ok && fwrite(ast->kind, 1, ast->count, fp) == ast->count
+        && fwrite(ast->flags, 1, ast->count, fp) == ast->count;
+    for (id = 0; id < comp->nameCount && w.ok; id++) {
+        Lexeme name = nameOf(comp, id);
+        w.ok = fwrite(name.str, 1, name.len, fp) == (size_t)name.len;
+    }
+    return w.ok;
+}
+
+/* AstFile is a binary syntax tree image in memory; the node
+   arrays are read in place with the astFile* accessors */
+typedef struct {
+    unsigned count; /* number of nodes */
+    unsigned arrayCount;
+    unsigned nameCount;
+    unsigned nameBytes;
+    int errors; /* the source had syntax errors (ASTERRORS) */
+    const unsigned char* end;
+    const unsigned char* value;
+    const unsigned char* line;
+    const unsigned char* arrays;
+    const unsigned char* names;
+    const unsigned char* kind;
+    const unsigned char* flags;
+    const char* bytes;
+} AstFile;
+
+#define astFileEnd(af, i) getU32((af)->end + 4 * (size_t)(i))
+#define astFileValue(af, i) ((int)getU32((af)->value + 4 * (size_t)(i)))
+#define astFileLine(af, i) ((int)getU32((af)->line + 4 * (size_t)(i)))
+
+/* openAstFile checks the header of the image [data, data + size)
+   and sets up af to read it in place. returns FALSE if it is not a
+   syntax tree file of this version */
+int openAstFile(AstFile* af, const void* data, size_t size)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    unsigned long long need;
+    if (size < ASTHEADER || memcmp(p, ASTMAGIC, 4) != 0 || p[4] != ASTVERSION)
+        return FALSE;
+    af->count = getU32(p + 8);
+    af->arrayCount = getU32(p + 12);
+    af->nameCount = getU32(p + 16);
+    af->nameBytes = getU32(p + 20);
+    af->errors = (p[5] & ASTERRORS) != 0;
+    need = ASTHEADER + 14ULL * af->count + 8ULL * af->arrayCount
+        + 4ULL * (af->nameCount + 1ULL) + af->nameBytes;
+    if (need != size)
+        return FALSE;
+    af->end = p + ASTHEADER;
+    af->value = af->end + 4 * (size_t)af->count;
+    af->line = af->value + 4 * (size_t)af->count;
+    af->arrays = af->line + 4 * (size_t)af->count;
+    af->names = af->arrays + 8 * (size_t)af->arrayCount;
+    af->kind = af->names + 4 * ((size_t)af->nameCount + 1);
+    af->flags = af->kind + af->count;
+    af->bytes = (const char*)(af->flags + af->count);
+    return TRUE;
+}
+
+/* astFileName returns name id of af as a view into the image, or
+   FALSE if the handle or the name table is damaged */
+static int astFileName(const AstFile* af, int id, Lexeme* name)
+{
+    unsigned from, to;
+    if (id == -1) {
+        name->str = "";
+        name->len = 0;
+        name->id = -1;
+        return TRUE;
+    }
+    if (id < 0 || (unsigned)id >= af->nameCount)
+        return FALSE;
+    from = getU32(af->names + 4 * (size_t)id);
+    to = getU32(af->names + 4 * ((size_t)id + 1));
+    if (from > to || to > af->nameBytes)
+        return FALSE;
+    name->str = af->bytes + from;
+    name->len = (int)(to - from);
+    name->id = id;
+    return TRUE;
+}
+
+/* listAstFile prints the tree of af the way printAst prints the
+   Ast it was written from. returns FALSE on a damaged record */
+static int listAstFile(Compiler* comp, const AstFile* af)
+{
+    AstIndent in = { 0 };
+    unsigned i;
+    int ok = TRUE;
+    for (i = 0; i < af->count && ok; i++) {
+        int kind = af->kind[i];
+        int value = astFileValue(af, i);
+        unsigned end = astFileEnd(af, i);
+        Lexeme name = { "", 0, -1 };
+        /* a subtree must lie inside the subtrees around it */
+        if (end <= i || end > af->count || (in.depth > 0 && in.ends[in.depth - 1] > i && end > in.ends[in.depth - 1]))
+            ok = FALSE;
+        else if (kind == ASTEXP + checkArrayVarK) {
+            const unsigned char* a = af->arrays + 8 * (size_t)value;
+            ok = value >= 0 && (unsigned)value < af->arrayCount && astFileName(af, (int)getU32(a), &name);
+            value = ok ? (int)getU32(a + 4) : 0;
+        }
+        else if (astHasName(kind))
+            ok = astFileName(af, value, &name);
+        if (ok)
+            ok = indentAst(comp, &in, i, end);
+        if (ok)
+            printAstNode(comp, kind, af->flags[i], name, value);
+    }
+    free(in.ends);
+    return ok;
+}
+
+
+////////////////////////////////////////////////// DRIVE.C 파일 ///////////////////////////////////////////
+/*
+Compiling many files in one process (parse -m). The sources come from
+a list file (one path per line) or from the .c files of a directory,
+and each one gets its own listing: the path with .c replaced by .txt
+(.txt is appended to other names).
+The files are sorted by size, largest first, and dealt round robin to
+one queue per worker thread, so the largest files are started first
+and a big file found late cannot hold up the end of the run. A worker
+takes the largest file left in its own queue; once that is empty it
+steals the smallest file left in another worker's queue. Every worker
+runs compileFile, which keeps its state in a Compiler of its own.
+A summary of the errors and of the times is printed at the end.
+(link with -pthread)
+*/
+
+#define DRIVESLOWEST 5 /* number of slowest files in the summary */
+
+typedef enum { JOBWAITING, JOBDONE, JOBSYNTAX, JOBFAILED } JobStatus;
+
+typedef struct {
+    char* path; /* source file */
+    long long size; /* bytes, for scheduling */
+    JobStatus status;
+    double seconds; /* time spent in compileFile */
+} DriveJob;
+
+#ifdef _WIN32
+typedef HANDLE DriveThread;
+typedef CRITICAL_SECTION DriveLock;
+static void initLock(DriveLock* l) { InitializeCriticalSection(l); }
+static void lockQueue(DriveLock* l) { EnterCriticalSection(l); }
+static void unlockQueue(DriveLock* l) { LeaveCriticalSection(l); }
+static void freeLock(DriveLock* l) { DeleteCriticalSection(l); }
+#else
+typedef pthread_t DriveThread;
+typedef pthread_mutex_t DriveLock;
+static void initLock(DriveLock* l) { pthread_mutex_init(l, NULL); }
+static void lockQueue(DriveLock* l) { pthread_mutex_lock(l); }
+static void unlockQueue(DriveLock* l) { pthread_mutex_unlock(l); }
+static void freeLock(DriveLock* l) { pthread_mutex_destroy(l); }
+#endif
+
+/* DriveQueue holds the jobs dealt to one worker, largest first;
+   the owner takes jobs[head++] and thieves take jobs[--tail] */
+typedef struct {
+    DriveLock lock;
+    int* jobs; /* indices into driveJobs */
+    int head, tail;
+} DriveQueue;
+
+static DriveJob* driveJobs = NULL;
+static int driveCount = 0;
+static int driveCapacity = 0;
+static DriveQueue* driveQueues = NULL;
+static int driveWorkers = 0;
+
+#ifdef _WIN32
+/* driveNow returns a monotonic time in seconds */
+static double driveNow(void)
+{
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+static int driveCpus(void)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+}
+#else
+static double driveNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+/* driveCpus returns the number of processors */
+static int driveCpus(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (int)n : 1;
+}
+#endif
+
+/* addJob appends the source file path to driveJobs;
+   returns FALSE if out of memory */
+static int addJob(const char* path, size_t n)
+{
+    struct stat st;
+    char* copy;
+    if (driveCount == driveCapacity) {
+        int cap = (driveCapacity == 0) ? 1024 : driveCapacity * 2;
+        DriveJob* grown = (DriveJob*)realloc(driveJobs, cap * sizeof(DriveJob));
+        if (grown == NULL) return FALSE;
+        driveJobs = grown;
+        driveCapacity = cap;
+    }
+    copy = (char*)malloc(n + 1);
+    if (copy == NULL) return FALSE;
+    memcpy(copy, path, n);
+    copy[n] = '\0';
+    driveJobs[driveCount].path = copy;
+    driveJobs[driveCount].size = (stat(copy, &st) == 0) ? (long long)st.st_size : 0;
+    driveJobs[driveCount].status = JOBWAITING;
+    driveJobs[driveCount].seconds = 0;
+    driveCount++;
+    return TRUE;
+}
+
+/* isSourceName tells whether a directory entry is a .c file */
+static int isSourceName(const char* name)
+{
+    size_t n = strlen(name);
+    return n > 2 && strcmp(name + n - 2, ".c") == 0;
+}
+
+/* addDirectory adds the .c files of the directory dir;
+   returns FALSE if dir is not a directory or out of memory */
+#ifdef _WIN32
+static int addDirectory(const char* dir)
+{
+    char pattern[MAX_PATH], path[MAX_PATH];
+    WIN32_FIND_DATAA fd;
+    HANDLE h;
+    int ok = TRUE;
+    snprintf(pattern, sizeof pattern, "%s\\*.c", dir);
+    h = FindFirstFileA(pattern, &fd);
+    if (h == INVALID_HANDLE_VALUE)
+        return GetLastError() == ERROR_FILE_NOT_FOUND;
+    do {
+        if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && isSourceName(fd.cFileName)) {
+            int n = snprintf(path, sizeof path, "%s\\%s", dir, fd.cFileName);
+            ok = addJob(path, (size_t)n);
+        }
+    } while (ok && FindNextFileA(h, &fd));
+    FindClose(h);
+    return ok;
+}
+#else
+static int addDirectory(const char* dir)
+{
+    DIR* d = opendir(dir);
+    struct dirent* e;
+    int ok = TRUE;
+    if (d == NULL) return FALSE;
+    while (ok && (e = readdir(d)) != NULL) {
+        size_t dn = strlen(dir), en = strlen(e->d_name);
+        char* path;
+        if (!isSourceName(e->d_name)) continue;
+        path = (char*)malloc(dn + en + 2);
+        if (path == NULL) { ok = FALSE; break; }
+        memcpy(path, dir, dn);
+        path[dn] = '/';
+        memcpy(path + dn + 1, e->d_name, en + 1);
+        ok = addJob(path, dn + en + 1);
+        free(path);
+    }
+    closedir(d);
+    return ok;
+}
+#endif
+
+/* addListFile adds the paths listed in the file name, one per line;
+   returns FALSE if it cannot be read or out of memory */
+static int addListFile(const char* name)
+{
+    FILE* fp = fopen(name, "r");
+    char line[4096];
+    int ok = TRUE;
+    if (fp == NULL) return FALSE;
+    while (ok && fgets(line, sizeof line, fp) != NULL) {
+        size_t n = strcspn(line, "\r\n");
+        if (n > 0)
+            ok = addJob(line, n);
+    }
+    fclose(fp);
+    return ok;
+}
+
+/* listingName makes the listing path of the source path */
+static void listingName(const char* path, char* out, size_t size)
+{
+    size_t n = strlen(path);
+    if (n > 2 && strcmp(path + n - 2, ".c") == 0)
+        n -= 2;
+    snprintf(out, size, "%.*s.txt", (int)n, path);
+}
+
+/* runJob compiles one file on the calling thread */
+static void runJob(DriveJob* job)
+{
+    char* PFile = (char*)malloc(strlen(job->path) + 5);
+    double start = driveNow();
+    int errors;
+    if (PFile == NULL) {
+        job->status = JOBFAILED;
+        return;
+    }
+    listingName(job->path, PFile, strlen(job->path) + 5);
+    if (!compileFile(job->path, PFile, &errors))
+        job->status = JOBFAILED;
+    else
+        job->status = errors ? JOBSYNTAX : JOBDONE;
+    job->seconds = driveNow() - start;
+    free(PFile);
+}
+
+/* takeJob returns the next job for worker self, or -1 when
+   every queue is empty (no jobs are added while workers run) */
+static int takeJob(int self)
+{
+    int i, j = -1;
+    DriveQueue* q = &driveQueues[self];
+    lockQueue(&q->lock);
+    if (q->head < q->tail)
+        j = q->jobs[q->head++];
+    unlockQueue(&q->lock);
+    for (i = 1; j < 0 && i < driveWorkers; i++) {
+        q = &driveQueues[(self + i) % driveWorkers];
+        lockQueue(&q->lock);
+        if (q->head < q->tail)
+            j = q->jobs[--q->tail];
+        unlockQueue(&q->lock);
+    }
+    return j;
+}
+
+/* driveWorker runs jobs until there are none left */
+static void driveWorker(int self)
+{
+    int j;
+    while ((j = takeJob(self)) >= 0)
+        runJob(&driveJobs[j]);
+}
+
+#ifdef _WIN32
+static unsigned __stdcall workerMain(void* arg) { driveWorker((int)(size_t)arg); return 0; }
+static int startWorker(DriveThread* th, int self)
+{
+    *th = (HANDLE)_beginthreadex(NULL, 0, workerMain, (void*)(size_t)self, 0, NULL);
+    return *th != 0;
+}
+static void joinWorker(DriveThread th) { WaitForSingleObject(th, INFINITE); CloseHandle(th); }
+#else
+static void* workerMain(void* arg) { driveWorker((int)(size_t)arg); return NULL; }
+static int startWorker(DriveThread* th, int self)
+{
+    return pthread_create(th, NULL, workerMain, (void*)(size_t)self) == 0;
+}
+static void joinWorker(DriveThread th) { pthread_join(th, NULL); }
+#endif
+
+/* bySize orders jobs largest first, then by path */
+static int bySize(const void* a, const void* b)
+{
+    const DriveJob* x = (const DriveJob*)a;
+    const DriveJob* y = (const DriveJob*)b;
+    if (x->size != y->size) return (x->size > y->size) ? -1 : 1;
+    return strcmp(x->path, y->path);
+}
+
+/* printSummary prints the errors and the times of the run */
+static void printSummary(double wall)
+{
+    int i, k, done = 0, syntax = 0, failed = 0;
+    int slowest[DRIVESLOWEST];
+    int nslow = 0;
+    double total = 0;
+    for (i = 0; i < driveCount; i++) {
+        DriveJob* job = &driveJobs[i];
+        total += job->seconds;
+        if (job->status == JOBDONE) done++;
+        else if (job->status == JOBSYNTAX) {
+            syntax++;
+            printf("syntax errors: %s\n", job->path);
+        }
+        else {
+            failed++;
+            printf("not compiled: %s\n", job->path);
+        }
+        /* keep the DRIVESLOWEST slowest jobs, slowest first */
+        for (k = nslow; k > 0 && driveJobs[slowest[k - 1]].seconds < job->seconds; k--)
+            if (k < DRIVESLOWEST) slowest[k] = slowest[k - 1];
+        if (k < DRIVESLOWEST) {
+            slowest[k] = i;
+            if (nslow < DRIVESLOWEST) nslow++;
+        }
+    }
+    printf("%d files: %d ok, %d with syntax errors, %d not compiled\n",
+        driveCount, done, syntax, failed);
+    printf("%d threads: %.3f s wall, %.3f s in compileFile, %.1f files/s\n",
+        driveWorkers, wall, total, (wall > 0) ? driveCount / wall : 0.0);
+    for (k = 0; k < nslow; k++)
+        printf("slowest: %.3f s %s (%lld bytes)\n", driveJobs[slowest[k]].seconds,
+            driveJobs[slowest[k]].path, driveJobs[slowest[k]].size);
+}
+
+/* driveMain runs parse -m <list file | directory> [threads];
+   returns 1 if any file had errors or could not be compiled */
+int driveMain(int argc, char* argv[])
+{
+    struct stat st;
+    DriveThread* threads;
+    int* started;
+    int i, ok, rc = 0;
+    double start;
+
+    driveWorkers = (argc > 3) ? atoi(argv[3]) : driveCpus();
+    if (argc < 3 || argc > 4 || driveWorkers < 1) {
+        fprintf(stderr, "usage: %s -m <list file | directory> [threads]\n", argv[0]);
+        return 1;
+    }
+    if (stat(argv[2], &st) == 0 && S_ISDIR(st.st_mode))
+        ok = addDirectory(argv[2]);
+    else
+        ok = addListFile(argv[2]);
+    if (!ok) {
+        fprintf(stderr, "File %s could not be read\n", argv[2]);
+        return 1;
+    }
+    if (driveWorkers > driveCount)
+        driveWorkers = (driveCount > 0) ? driveCount : 1;
+
+    qsort(driveJobs, driveCount, sizeof(DriveJob), bySize);
+    driveQueues = (DriveQueue*)calloc(driveWorkers, sizeof(DriveQueue));
+    threads = (DriveThread*)calloc(driveWorkers, sizeof(DriveThread));
+    started = (int*)calloc(driveWorkers, sizeof(int));
+    if (driveQueues == NULL || threads == NULL || started == NULL) {
+        fprintf(stderr, "Out of memory error\n");
+        exit(1);
+    }
+    for (i = 0; i < driveWorkers; i++) {
+        driveQueues[i].jobs = (int*)malloc((driveCount / driveWorkers + 1) * sizeof(int));
+        if (driveQueues[i].jobs == NULL) {
+            fprintf(stderr, "Out of memory error\n");
+            exit(1);
+        }
+        initLock(&driveQueues[i].lock);
+    }
+    for (i = 0; i < driveCount; i++) {
+        DriveQueue* q = &driveQueues[i % driveWorkers];
+        q->jobs[q->tail++] = i;
+    }
+
+    start = driveNow();
+    /* worker 0 is the calling thread; the queue of a worker that
+       cannot be started is emptied by stealing */
+    for (i = 1; i < driveWorkers; i++)
+        started[i] = startWorker(&threads[i], i);
+    driveWorker(0);
+    for (i = 1; i < driveWorkers; i++)
+        if (started[i])
+            joinWorker(threads[i]);
+    printSummary(driveNow() - start);
+
+    for (i = 0; i < driveCount; i++) {
+        if (driveJobs[i].status != JOBDONE) rc = 1;
+        free(driveJobs[i].path);
+    }
+    for (i = 0; i < driveWorkers; i++) {
+        freeLock(&driveQueues[i].lock);
+        free(driveQueues[i].jobs);
+    }
+    free(driveJobs);
+    free(driveQueues);
+    free(threads);
+    free(started);
+    return rc;
+}
+
+///////////////////////////////////////////////////   MAIN.C 파일    //////////////////////////
+/* openSource makes the Compiler of one compilation and opens and
+   maps the file SFile (fopen mode) for it.
+   returns NULL if it cannot be read or out of memory */
+static Compiler* openSource(const char* SFile, const char* mode)
+{
+    Compiler* comp = (Compiler*)calloc(1, sizeof(Compiler));
+    char* outBuf = (char*)malloc(OUTBUFSIZE);
+    if (comp == NULL || outBuf == NULL)
+    {
+        fprintf(stderr, "Out of memory error\n");
+        free(comp);
+        free(outBuf);
+        return NULL;
+    }
+    comp->outBuf = outBuf;
+    comp->EchoSource = FALSE;
+    comp->TraceScan = FALSE;
+    comp->TraceParse = TRUE;
+    comp->tokenString = "";
+    comp->tokenName = -1;
+    comp->source = fopen(SFile, mode);
+    if (comp->source == NULL)
     {
         fprintf(stderr, "File %s not found\n", SFile);
-        exit(1);
+        free(outBuf);
+        free(comp);
+        return NULL;
+    }
+    if (!mapSource(comp, comp->source))
+    {
+        fprintf(stderr, "File %s could not be read\n", SFile);
+        fclose(comp->source);
+        free(outBuf);
+        free(comp);
+        return NULL;
+    }
+    return comp;
+}
+
+/* closeSource releases the source, what was built from it
+   and the Compiler itself */
+static void closeSource(Compiler* comp)
+{
+    freeTokens(&comp->tokens);
+    freeNames(comp);
+    freeArena(comp);
+    unmapSource(comp);
+    fclose(comp->source);
+    free(comp->outBuf);
+    free(comp);
+}
+
+/* compileFile parses the source file SFile and writes its listing
+   to PFile. Its state is a Compiler made and released here, so any
+   number of files may be compiled one after another or at the same
+   time. Returns FALSE if a file cannot be opened or read; syntax
+   errors are reported in the listing and *errors (unless errors
+   is NULL) says whether there were any */
+int compileFile(const char* SFile, const char* PFile, int* errors)
+{
+    TreeNode* syntaxTree;
+    Compiler* comp = openSource(SFile, "r");
+    if (comp == NULL)
+        return FALSE;
+    comp->listing = fopen(PFile, "w");
+    if (comp->listing == NULL)
+    {
+        fprintf(stderr, "File %s could not be written\n", PFile);
+        closeSource(comp);
+        return FALSE;
     }
     //fprintf(listing, "\nTINY COMPILATION: %s\n", SFile); // 그냥 TINY COMPILATION으로 칭함.
     //fprintf(listing, "\nC- language: %s\n", SFile);
 
     //while (getToken() != ENDFILE);
 
-    syntaxTree = parse();
-    if (TraceParse) {
-        fprintf(listing, "\nSyntax tree:\n");
-        printTree(syntaxTree);
+    syntaxTree = parse(comp);
+    if (comp->TraceParse) {
+        /* the tree is printed from its compact copy, and the
+           TreeNodes are released before that */
+        Ast ast = { 0 };
+        int compacted = compactTree(syntaxTree, &ast);
+        outText(comp, "\nSyntax tree:\n");
+        if (compacted) {
+            resetArena(comp);
+            printAst(comp, &ast);
+        }
+        else
+            printTree(comp, syntaxTree);
+        freeAst(&ast);
     }
 
     // 파일닫기
-    fclose(source);
-    fclose(listing);
+    outFlush(comp);
+    fclose(comp->listing);
+    if (errors != NULL)
+        *errors = comp->Error;
+    closeSource(comp);
+    return TRUE;
+}
+
+/* compileAstFile parses the source file SFile and writes its syntax
+   tree to AFile (parse -b, see ASTFILE.C); syntax errors go to
+   stderr and are marked in the file. Returns FALSE if a file cannot
+   be read or written, or if the source has syntax errors */
+int compileAstFile(const char* SFile, const char* AFile)
+{
+    Ast ast = { 0 };
+    FILE* fp;
+    int ok;
+    Compiler* comp = openSource(SFile, "r");
+    if (comp == NULL)
+        return FALSE;
+    fp = fopen(AFile, "wb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "File %s could not be written\n", AFile);
+        closeSource(comp);
+        return FALSE;
+    }
+    comp->listing = stderr;
+    ok = compactTree(parse(comp), &ast) && writeAstFile(comp, &ast, fp);
+    if (fclose(fp) != 0)
+        ok = FALSE;
+    if (!ok)
+        fprintf(stderr, "File %s could not be written\n", AFile);
+    else if (comp->Error) {
+        fprintf(stderr, "File %s has syntax errors\n", SFile);
+        ok = FALSE;
+    }
+    outFlush(comp);
+    freeAst(&ast);
+    closeSource(comp);
+    return ok;
+}
+
+/* listTreeFile prints the syntax tree file AFile to the listing
+   PFile (parse -r) as compileFile prints the tree. Returns FALSE
+   if it cannot be read or written, is damaged, or was made from a
+   source with syntax errors */
+int listTreeFile(const char* AFile, const char* PFile)
+{
+    AstFile af;
+    int ok;
+    Compiler* comp = openSource(AFile, "rb");
+    if (comp == NULL)
+        return FALSE;
+    ok = openAstFile(&af, comp->srcBuf, comp->srcLen);
+    if (!ok)
+        fprintf(stderr, "File %s is not a syntax tree file\n", AFile);
+    else if ((comp->listing = fopen(PFile, "w")) == NULL) {
+        fprintf(stderr, "File %s could not be written\n", PFile);
+        ok = FALSE;
+    }
+    else {
+        outText(comp, "\nSyntax tree:\n");
+        if (!listAstFile(comp, &af)) {
+            fprintf(stderr, "File %s is damaged\n", AFile);
+            ok = FALSE;
+        }
+        else if (af.errors) {
+            fprintf(stderr, "File %s was made from a source with syntax errors\n", AFile);
+            ok = FALSE;
+        }
+        outFlush(comp);
+        fclose(comp->listing);
+    }
+    closeSource(comp);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    char PFile[120]; /* 스캔한 결과 출력대상 파일*/
+    char SFile[120]; /* source code file name */
+    int binary = FALSE; /* -b: write a binary syntax tree instead of a listing */
+    int readBack = FALSE; /* -r: the source is a syntax tree file to be listed */
+    int argi = 1;
+    int ok;
+    if (argc > 1 && strcmp(argv[1], "-m") == 0)
+        return driveMain(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        binary = TRUE;
+        argi++;
+    }
+    else if (argc > 1 && strcmp(argv[1], "-r") == 0) {
+        readBack = TRUE;
+        argi++;
+    }
+    if (argc - argi != 2)
+    {
+        fprintf(stderr, "usage: %s [-b | -r] <filename> <listing>\n", argv[0]);
+        fprintf(stderr, "       %s -m <list file | directory> [threads]\n", argv[0]);
+        exit(1);
+    }
+
+    //source code file 처리작업
+    strcpy(SFile, argv[argi]);
+    if (strchr(SFile, '.') == NULL)
+        strcat(SFile, readBack ? ".ast" : ".c");
+
+    // 스캔한 결과 출력대상 file 처리작업
+    strcpy(PFile, argv[argi + 1]);
+    if (strchr(PFile, '.') == NULL)
+        strcat(PFile, binary ? ".ast" : ".txt");
+
+    if (readBack)
+        ok = listTreeFile(SFile, PFile);
+    else if (binary)
+        ok = compileAstFile(SFile, PFile);
+    else
+        ok = compileFile(SFile, PFile, NULL);
+    if (!ok)
+        exit(1);
 
     return 0;
 }
\ No newline at end of file
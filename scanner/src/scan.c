@@ -2,7 +2,34 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI /* wingdi.h defines ERROR */
+#include <windows.h>
+#include <process.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCAN_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 /*
 Scanner구현은 Scanner만을 위해 각 헤더파일, C파일을 나누지 않고 하나의 Scan.c에서 처리함.
@@ -13,6 +40,32 @@ Scanner구현은 Scanner만을 위해 각 헤더파일, C파일을 나누지 않
 #define FALSE 0
 #define TRUE 1
 
+/* THREAD_LOCAL marks the scanner state that every scanning
+   thread keeps for itself (see PSCAN.C) */
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+/* ALWAYS_INLINE functions are inlined into every caller, so a
+   call with constant arguments becomes a copy specialized for
+   them (see scanToken) */
+#ifdef _MSC_VER
+#define ALWAYS_INLINE static __forceinline
+#else
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+#endif
+
+/* Building with -DNOTRACE makes a scanner without echo and
+   tracing: getToken has no tracing instances and EchoSource and
+   TraceScan start off */
+#ifdef NOTRACE
+#define TRACE_DEFAULT FALSE
+#else
+#define TRACE_DEFAULT TRUE
+#endif
+
 /* MAXRESERVED = the number of reserved words */
 #define MAXRESERVED 6 // else, if, int, return, void, while
 
@@ -35,29 +88,174 @@ typedef enum {
 } TokenType;
 
 FILE* listing; /* listing output text file */
-int lineno = 0; /* source line number for listing */
+THREAD_LOCAL int lineno = 0; /* source line number for listing */
 FILE* source; /* source code text file */
 
 /* EchoSource = TRUE causes the source program to
  * be echoed to the listing file with line numbers
  * during parsing
  */
-int EchoSource = TRUE;
+THREAD_LOCAL int EchoSource = TRACE_DEFAULT;
 
 
 /* TraceScan = TRUE causes token information to be
  * printed to the listing file as each token is
  * recognized by the scanner
  */
-int TraceScan = TRUE;
+THREAD_LOCAL int TraceScan = TRACE_DEFAULT;
 
 
 ////////////////////////////////////////////////// UTIL.C 파일 ///////////////////////////////////////////
 
+/* The listing is written through outBuf, a large buffer that
+   goes to the listing file in one fwrite when it fills up (or on
+   outFlush), instead of one fprintf per token, line or space.
+   Numbers are formatted by hand and indentation is copied in
+   blocks. outFlush must run before the listing is closed.
+   Echoed source lines are not copied at all where there is writev
+   (outSource): the pieces of outBuf and slices of srcBuf are queued
+   in outIov and written in order by a few writev calls, so srcBuf
+   must also stay mapped until outFlush. */
+#define OUTBUFSIZE (1 << 20)
+static char outBuf[OUTBUFSIZE];
+static size_t outLen = 0; /* number of bytes waiting in outBuf */
+
+#ifndef _WIN32
+#define OUTIOVS 4096 /* size of outIov */
+#define IOVBATCH 1024 /* entries per writev call (IOV_MAX on Linux) */
+static struct iovec outIov[OUTIOVS];
+static int outIovCount = 0;
+static size_t outMark = 0; /* outBuf[0, outMark) is already in outIov */
+
+/* outCut queues the bytes of outBuf that are not in outIov yet */
+static void outCut(void)
+{
+    if (outLen > outMark) {
+        outIov[outIovCount].iov_base = outBuf + outMark;
+        outIov[outIovCount].iov_len = outLen - outMark;
+        outIovCount++;
+        outMark = outLen;
+    }
+}
+
+/* outWritev writes all of iov[0, n) to fd, picking up after
+   short writes. returns FALSE on a write error */
+static int outWritev(int fd, struct iovec* iov, int n)
+{
+    while (n > 0) {
+        ssize_t done = writev(fd, iov, (n < IOVBATCH) ? n : IOVBATCH);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            return FALSE;
+        }
+        while (n > 0 && (size_t)done >= iov->iov_len) {
+            done -= (ssize_t)iov->iov_len;
+            iov++;
+            n--;
+        }
+        if (n > 0) {
+            iov->iov_base = (char*)iov->iov_base + done;
+            iov->iov_len -= (size_t)done;
+        }
+    }
+    return TRUE;
+}
+#endif
+
+/* outFlush writes out everything waiting in outBuf (and outIov) */
+void outFlush(void)
+{
+#ifndef _WIN32
+    outCut();
+    if (outIovCount > 0) {
+        fflush(listing); /* anything fprintf'd to the listing goes first */
+        outWritev(fileno(listing), outIov, outIovCount);
+    }
+    outIovCount = 0;
+    outMark = 0;
+#else
+    if (outLen > 0)
+        fwrite(outBuf, 1, outLen, listing);
+#endif
+    outLen = 0;
+}
+
+/* outChars appends the n bytes at s to the listing */
+static void outChars(const char* s, size_t n)
+{
+    if (n > OUTBUFSIZE - outLen) {
+        outFlush();
+        if (n >= OUTBUFSIZE) {
+            fwrite(s, 1, n, listing);
+            return;
+        }
+    }
+    memcpy(outBuf + outLen, s, n);
+    outLen += n;
+}
+
+/* outText appends a NUL-terminated string to the listing */
+static void outText(const char* s)
+{
+    outChars(s, strlen(s));
+}
+
+/* outSource appends n bytes of srcBuf to the listing
+   without copying them (see outBuf) */
+static void outSource(const char* s, size_t n)
+{
+#ifndef _WIN32
+    /* room for the cut, the slice and the cut outFlush makes */
+    if (outIovCount + 3 > OUTIOVS) outFlush();
+    outCut();
+    outIov[outIovCount].iov_base = (void*)s;
+    outIov[outIovCount].iov_len = n;
+    outIovCount++;
+#else
+    outChars(s, n);
+#endif
+}
+
+/* outChar appends one character to the listing */
+static void outChar(char c)
+{
+    if (outLen == OUTBUFSIZE) outFlush();
+    outBuf[outLen++] = c;
+}
+
+/* outSpaces appends n blanks to the listing */
+static void outSpaces(int n)
+{
+    static const char blanks[64] =
+        "                                                                ";
+    while (n > 0) {
+        int k = (n < 64) ? n : 64;
+        outChars(blanks, k);
+        n -= k;
+    }
+}
+
+/* outInt appends v in decimal, right-aligned in width
+   columns like printf's %*d */
+static void outInt(int v, int width)
+{
+    char digits[12];
+    int n = 0;
+    unsigned u = (v < 0) ? 0u - (unsigned)v : (unsigned)v;
+    do {
+        digits[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+    if (v < 0) digits[n++] = '-';
+    if (width > n) outSpaces(width - n);
+    if (OUTBUFSIZE - outLen < (size_t)n) outFlush();
+    while (n > 0) outBuf[outLen++] = digits[--n];
+}
+
 /* Procedure printToken prints a token
-* and its lexeme to the listing file
+* and its lexeme (tokenLength bytes) to the listing file
 */
-void printToken(TokenType token, const char* tokenString)
+void printToken(TokenType token, const char* tokenString, size_t tokenLength)
 {
     switch (token)
     {
@@ -68,54 +266,78 @@ void printToken(TokenType token, const char* tokenString)
     case VOID:
     case WHILE:
 
-        fprintf(listing,
-            "reserved word: %s\n", tokenString);
+        outText("reserved word: ");
+        outChars(tokenString, tokenLength);
+        outChar('\n');
         break;
-    case PLUS: fprintf(listing, "+\n"); break;
-    case MINUS: fprintf(listing, "-\n"); break;
-    case TIMES: fprintf(listing, "*\n"); break;
-    case OVER: fprintf(listing, "/\n"); break;
-    case LT: fprintf(listing, "<\n"); break;
-    case LTE: fprintf(listing, "<=\n"); break;
-    case GT: fprintf(listing, ">\n"); break;
-    case GTE: fprintf(listing, ">=\n"); break;
-    case EQ: fprintf(listing, "==\n"); break;
-    case NE: fprintf(listing, "!=\n"); break;
-    case ASSIGN: fprintf(listing, "=\n"); break; // TINY에서는 ':=' 이거지만, 여기서는 '='로 ASSIGN표현
-    case SEMI: fprintf(listing, ";\n"); break;
-    case COMMA: fprintf(listing, ",\n"); break;
-    case LPAREN: fprintf(listing, "(\n"); break;
-    case RPAREN: fprintf(listing, ")\n"); break;
-    case LBRACK: fprintf(listing, "[\n"); break;
-    case RBRACK: fprintf(listing, "]\n"); break;
-    case LBRACE: fprintf(listing, "{\n"); break;
-    case RBRACE: fprintf(listing, "}\n"); break;
-    case ENDFILE: fprintf(listing, "EOF\n"); break;
-    case STOP_BEFORE_END: fprintf(listing, "stop before ending\n"); break;
+    case PLUS: outText("+\n"); break;
+    case MINUS: outText("-\n"); break;
+    case TIMES: outText("*\n"); break;
+    case OVER: outText("/\n"); break;
+    case LT: outText("<\n"); break;
+    case LTE: outText("<=\n"); break;
+    case GT: outText(">\n"); break;
+    case GTE: outText(">=\n"); break;
+    case EQ: outText("==\n"); break;
+    case NE: outText("!=\n"); break;
+    case ASSIGN: outText("=\n"); break; // TINY에서는 ':=' 이거지만, 여기서는 '='로 ASSIGN표현
+    case SEMI: outText(";\n"); break;
+    case COMMA: outText(",\n"); break;
+    case LPAREN: outText("(\n"); break;
+    case RPAREN: outText(")\n"); break;
+    case LBRACK: outText("[\n"); break;
+    case RBRACK: outText("]\n"); break;
+    case LBRACE: outText("{\n"); break;
+    case RBRACE: outText("}\n"); break;
+    case ENDFILE: outText("EOF\n"); break;
+    case STOP_BEFORE_END: outText("stop before ending\n"); break;
     case NUM:
-        fprintf(listing,
-            "NUM, val= %s\n", tokenString);
+        outText("NUM, val= ");
+        outChars(tokenString, tokenLength);
+        outChar('\n');
         break;
     case ID:
-        fprintf(listing,
-            "ID, name= %s\n", tokenString);
+        outText("ID, name= ");
+        outChars(tokenString, tokenLength);
+        outChar('\n');
         break;
     case ERROR:
-        fprintf(listing,
-            "Error: %s\n", tokenString); // 에러토큰의 경우 "Error: 해당 error string"
+        outText("Error: ");
+        outChars(tokenString, tokenLength);
+        outChar('\n'); // 에러토큰의 경우 "Error: 해당 error string"
         break;
     default: /* should never happen */
-        fprintf(listing, "Unknown token: %d\n", token);
+        outText("Unknown token: ");
+        outInt(token, 0);
+        outChar('\n');
     }
 }
 
 
 ////////////////////////////////////////////////// SCAN.H 헤더 파일 ///////////////////////////////////////////
-/* MAXTOKENLEN is the maximum size of a token */
-#define MAXTOKENLEN 40
+/* tokenString points at the lexeme of the last token inside
+   the source buffer. It is tokenLength bytes long and is not
+   NUL-terminated, so lexemes of any length are never copied */
+THREAD_LOCAL const char* tokenString = ""; // SCAN.C파일에도 들어감
+
+THREAD_LOCAL size_t tokenLength = 0;
+/* tokenOffset is the position of tokenString in the source buffer */
+THREAD_LOCAL size_t tokenOffset = 0;
 
-/* tokenString array stores the lexeme of each token */
-char tokenString[MAXTOKENLEN + 1]; // SCAN.C파일에도 들어감
+/* TokenBuffer holds a run of tokens in struct-of-arrays form:
+   token i is kind[i], spelled by the source bytes
+   [offset[i], offset[i] + length[i]) and found on line[i] */
+typedef struct {
+    int count; /* number of tokens in the buffer */
+    int capacity; /* number of tokens the arrays can hold */
+    unsigned char* kind; /* TokenType of each token */
+    size_t* offset;
+    int* length;
+    int* line;
+} TokenBuffer;
+
+/* TOKENCHUNK = number of tokens scanned per batch */
+#define TOKENCHUNK 65536
 
 
 
@@ -124,318 +346,2074 @@ char tokenString[MAXTOKENLEN + 1]; // SCAN.C파일에도 들어감
 typedef enum {
     // 기존 TINY참고자료에 비해 추가되는 state는 2개의 연산자가 겹쳐 표현되는 것들
     // 즉, ==, <=, >=, !=, /*, */ 을 순서대로 IN_ASSIGN, IN_LT, IN_GT, IN_NE, IN_OVER로 state표현
-    START, IN_ASSIGN, IN_COMMENT, IN_NUM, IN_ID, DONE, IN_LT, IN_GT, IN_NE, IN_OVER
+    // IN_COMMENT_STAR는 comment 안에서 '*'를 읽은 상태 ('*/'로 닫히는지 확인)
+    START, IN_ASSIGN, IN_COMMENT, IN_NUM, IN_ID, DONE, IN_LT, IN_GT, IN_NE, IN_OVER,
+    IN_COMMENT_STAR,
+    NUMSTATES
 }StateType;
 
+/* character classes of the lexer DFA */
+typedef enum {
+    CC_OTHER, CC_LETTER, CC_DIGIT, CC_BLANK,
+    CC_ASSIGN, CC_LT, CC_GT, CC_BANG, CC_SLASH, CC_STAR,
+    CC_PLUS, CC_MINUS, CC_LPAREN, CC_RPAREN, CC_LBRACE, CC_RBRACE,
+    CC_LBRACK, CC_RBRACK, CC_SEMI, CC_COMMA,
+    CC_EOF,
+    NUMCLASSES
+} CharClass;
 
-/* BUFLEN = length of the input buffer for
-   source code lines */
-#define BUFLEN 256
+/* charClass maps every input byte to its CharClass.
+   Plain ASCII ranges are used, so the scanner does not
+   depend on the current locale the way isalpha/isdigit do */
+static const unsigned char charClass[256] = {
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 00-07 */
+    CC_OTHER, CC_BLANK, CC_BLANK, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 08-0F */
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 10-17 */
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 18-1F */
+    CC_BLANK, CC_BANG, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER, /* 20-27 */
+    CC_LPAREN, CC_RPAREN, CC_STAR, CC_PLUS, CC_COMMA, CC_MINUS, CC_OTHER, CC_SLASH, /* 28-2F */
+    CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT, /* 30-37 */
+    CC_DIGIT, CC_DIGIT, CC_OTHER, CC_SEMI, CC_LT, CC_ASSIGN, CC_GT, CC_OTHER, /* 38-3F */
+    CC_OTHER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 40-47 */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 48-4F */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 50-57 */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LBRACK, CC_OTHER, CC_RBRACK, CC_OTHER, CC_OTHER, /* 58-5F */
+    CC_OTHER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 60-67 */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 68-6F */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, /* 70-77 */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LBRACE, CC_OTHER, CC_RBRACE, CC_OTHER, CC_OTHER, /* 78-7F */
+    /* 80-FF: CC_OTHER */
+};
 
-static char lineBuf[BUFLEN]; /* holds the current line */
-static int linepos = 0; /* current position in LineBuf */
-static int bufsize = 0; /* current size of buffer string */
-static int EOF_flag = FALSE; /* corrects ungetNextChar behavior on EOF */
 
-/* getNextChar fetches the next non-blank character
-   from lineBuf, reading in a new line if lineBuf is
-   exhausted */
-static int getNextChar(void)
+/* The whole source file is mapped into srcBuf once and
+   getNextChar scans straight over the mapped bytes.
+   lineEnd marks the end of the current line so that
+   lineno and EchoSource still work line by line. */
+static const char* srcBuf = NULL; /* holds the whole source file */
+static THREAD_LOCAL size_t srcLen = 0; /* size of srcBuf in bytes (end of the chunk being scanned) */
+static THREAD_LOCAL size_t srcPos = 0; /* current position in srcBuf */
+static THREAD_LOCAL size_t lineEnd = 0; /* end of the current line in srcBuf */
+static int srcMapped = FALSE; /* srcBuf came from mmap (else malloc) */
+static THREAD_LOCAL int EOF_flag = FALSE; /* corrects ungetNextChar behavior on EOF */
+/* state the next getToken call starts in; IN_COMMENT when
+   a chunk is known to begin inside a comment */
+static THREAD_LOCAL StateType resumeState = START;
+
+/* mapSource loads the whole source file into srcBuf.
+   It maps the file where possible and falls back to reading
+   it in one piece (pipes, platforms without mmap).
+   returns FALSE if the file cannot be read */
+static int mapSource(FILE* fp)
+{
+    char* buf = NULL;
+    size_t cap = 0;
+    size_t n;
+#ifndef _WIN32
+    struct stat st;
+    if (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            srcBuf = "";
+            srcLen = 0;
+            return TRUE;
+        }
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+        if (p != MAP_FAILED) {
+            srcBuf = (const char*)p;
+            srcLen = (size_t)st.st_size;
+            srcMapped = TRUE;
+            return TRUE;
+        }
+    }
+#endif
+    srcLen = 0;
+    do {
+        if (srcLen == cap) {
+            char* grown;
+            cap = (cap == 0) ? 65536 : cap * 2;
+            grown = (char*)realloc(buf, cap);
+            if (grown == NULL) {
+                free(buf);
+                return FALSE;
+            }
+            buf = grown;
+        }
+        n = fread(buf + srcLen, 1, cap - srcLen, fp);
+        srcLen += n;
+    } while (n > 0);
+    if (ferror(fp)) {
+        free(buf);
+        return FALSE;
+    }
+    if (srcLen == 0) {
+        /* empty input looks like an empty file: unmapSource
+           only frees srcBuf when srcLen > 0 */
+        free(buf);
+        srcBuf = "";
+        return TRUE;
+    }
+    srcBuf = buf;
+    return TRUE;
+}
+
+/* unmapSource releases srcBuf */
+static void unmapSource(void)
 {
-    if (!(linepos < bufsize))
+#ifndef _WIN32
+    if (srcMapped) munmap((void*)srcBuf, srcLen);
+    else
+#endif
+    if (srcLen > 0) free((void*)srcBuf);
+    srcBuf = NULL;
+    srcLen = srcPos = lineEnd = 0;
+    srcMapped = FALSE;
+}
+
+/* getNextChar fetches the next character from srcBuf,
+   moving on to the next line (and echoing it if echo) when
+   the current line is exhausted */
+ALWAYS_INLINE int getNextChar(int echo)
+{
+    if (!(srcPos < lineEnd))
     {
         lineno++;
-        if (fgets(lineBuf, BUFLEN - 1, source)) {
-            if (EchoSource) fprintf(listing, "%4d: %s", lineno, lineBuf);
-            bufsize = strlen(lineBuf);
-            linepos = 0;
-            return lineBuf[linepos++]; // ++후위연산
+        if (srcPos < srcLen) {
+            const char* nl = memchr(srcBuf + srcPos, '\n', srcLen - srcPos);
+            lineEnd = (nl != NULL) ? (size_t)(nl - srcBuf) + 1 : srcLen;
+            if (echo) {
+                outInt(lineno, 4);
+                outText(": ");
+                outSource(srcBuf + srcPos, lineEnd - srcPos);
+            }
+            return (unsigned char)srcBuf[srcPos++]; // ++후위연산
         }
         else {
             EOF_flag = TRUE;
             return EOF;
         }
-    }/
+    }
     else
-        return lineBuf[linepos++];
+        return (unsigned char)srcBuf[srcPos++];
 }
 
-/* ungetNextChar backtracks one character in lineBuf */
+/* ungetNextChar backtracks one character in srcBuf.
+   lineEnd is kept, so backing up over the first character
+   of a line does not count or echo that line twice */
 static void ungetNextChar(void) {
-    if (!EOF_flag) linepos--;
+    if (!EOF_flag) srcPos--;
+}
+
+/* Fast paths for getToken: blanks, comment bodies and letter/digit
+   runs are skipped a whole block at a time (32 bytes with AVX2,
+   16 with SSE2) instead of one getNextChar call per byte.
+   They never look past lineEnd, so lineno and EchoSource are
+   still handled by getNextChar. */
+#if defined(SCAN_AVX2)
+#define SIMD_WIDTH 32
+#define SIMD_FULL 0xFFFFFFFFu
+typedef __m256i simd_t;
+#define simdLoad(p) _mm256_loadu_si256((const __m256i*)(p))
+#define simdSet(c) _mm256_set1_epi8((char)(c))
+#define simdEq(a, b) _mm256_cmpeq_epi8(a, b)
+#define simdLt(a, b) _mm256_cmpgt_epi8(b, a)
+#define simdOr(a, b) _mm256_or_si256(a, b)
+#define simdAdd(a, b) _mm256_add_epi8(a, b)
+#define simdMask(a) ((unsigned)_mm256_movemask_epi8(a))
+#elif defined(SCAN_SSE2)
+#define SIMD_WIDTH 16
+#define SIMD_FULL 0xFFFFu
+typedef __m128i simd_t;
+#define simdLoad(p) _mm_loadu_si128((const __m128i*)(p))
+#define simdSet(c) _mm_set1_epi8((char)(c))
+#define simdEq(a, b) _mm_cmpeq_epi8(a, b)
+#define simdLt(a, b) _mm_cmplt_epi8(a, b)
+#define simdOr(a, b) _mm_or_si128(a, b)
+#define simdAdd(a, b) _mm_add_epi8(a, b)
+#define simdMask(a) ((unsigned)_mm_movemask_epi8(a))
+#endif
+
+#ifdef SIMD_WIDTH
+/* lowestBit returns the index of the lowest set bit of m (m != 0) */
+static int lowestBit(unsigned m)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return (int)i;
+#else
+    return __builtin_ctz(m);
+#endif
 }
 
-/* lookup table of reserved words */
-static struct {
-    char* str;
+/* simdRange marks the bytes of v in [lo, lo + n) using a
+   signed compare on bytes shifted by 0x80 - lo */
+static simd_t simdRange(simd_t v, int lo, int n)
+{
+    return simdLt(simdAdd(v, simdSet(0x80 - lo)), simdSet(n - 0x80));
+}
+#endif
+
+/* skipBlanks returns the first position in [pos, end)
+   that is not a blank, tab or newline */
+static size_t skipBlanks(size_t pos, size_t end)
+{
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        simd_t v = simdLoad(srcBuf + pos);
+        unsigned m = simdMask(simdOr(simdOr(simdEq(v, simdSet(' ')), simdEq(v, simdSet('\t'))), simdEq(v, simdSet('\n'))));
+        if (m != SIMD_FULL) return pos + lowestBit(~m);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && (srcBuf[pos] == ' ' || srcBuf[pos] == '\t' || srcBuf[pos] == '\n')) pos++;
+    return pos;
+}
+
+/* findStar returns the position of the next '*' in [pos, end),
+   i.e. the only place a comment can be closed */
+static size_t findStar(size_t pos, size_t end)
+{
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        unsigned m = simdMask(simdEq(simdLoad(srcBuf + pos), simdSet('*')));
+        if (m != 0) return pos + lowestBit(m);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && srcBuf[pos] != '*') pos++;
+    return pos;
+}
+
+/* spanLetters returns the end of the run of letters starting at pos */
+static size_t spanLetters(size_t pos, size_t end)
+{
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        unsigned m = simdMask(simdRange(simdOr(simdLoad(srcBuf + pos), simdSet(0x20)), 'a', 26));
+        if (m != SIMD_FULL) return pos + lowestBit(~m);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && charClass[(unsigned char)srcBuf[pos]] == CC_LETTER) pos++;
+    return pos;
+}
+
+/* spanDigits returns the end of the run of digits starting at pos */
+static size_t spanDigits(size_t pos, size_t end)
+{
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        unsigned m = simdMask(simdRange(simdLoad(srcBuf + pos), '0', 10));
+        if (m != SIMD_FULL) return pos + lowestBit(~m);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && charClass[(unsigned char)srcBuf[pos]] == CC_DIGIT) pos++;
+    return pos;
+}
+
+/* lookup table of reserved words, indexed by RESERVEDHASH.
+   The hash mixes the first character with the length and puts
+   each of the MAXRESERVED words in its own slot, so an identifier
+   is compared against at most one candidate. */
+#define RESERVEDSLOTS 8
+#define RESERVEDHASH(s, len) ((((unsigned char)(s)[0] >> 1) + ((len) << 2)) & (RESERVEDSLOTS - 1))
+
+static const struct {
+    const char* str;
+    size_t len;
     TokenType tok;
 }
-reservedWords[MAXRESERVED] // 지정해주신 keyworkds는 6개
-= { {"else",ELSE} ,{"if",IF}, {"int",INT},
-    {"return",RETURN}, {"void",VOID}, {"while", WHILE}
+reservedWords[RESERVEDSLOTS] // 지정해주신 keyworkds는 6개, 빈 slot은 len 0
+= { {"int", 3, INT}, {"return", 6, RETURN}, {"else", 4, ELSE}, {"void", 4, VOID},
+    {"if", 2, IF}, {NULL, 0, ID}, {NULL, 0, ID}, {"while", 5, WHILE}
 };
 
 /* lookup an identifier to see if it is a reserved word */
-/* uses linear search */
-static TokenType reservedLookup(char* s) {
-    int i;
-    for (i = 0; i < MAXRESERVED; i++)
-        if (!strcmp(s, reservedWords[i].str))
-            return reservedWords[i].tok;
+/* uses the perfect hash above: one length check and one memcmp */
+static TokenType reservedLookup(const char* s, size_t len) {
+    int h;
+    if (len < 2 || len > 6) // reserved word 길이는 2~6
+        return ID;
+    h = RESERVEDHASH(s, len);
+    if (reservedWords[h].len == len && memcmp(s, reservedWords[h].str, len) == 0)
+        return reservedWords[h].tok;
     return ID;
 }
 
 
+/* transition table of the lexer DFA, indexed by [state][CharClass].
+   GO moves to another state and keeps the character in the lexeme,
+   ACCEPT finishes a token that includes the character and
+   BACKUP finishes a token before it (ungetNextChar) */
+typedef struct {
+    unsigned char next; /* next state */
+    unsigned char token; /* token returned when next == DONE */
+    unsigned char unget; /* TRUE if the character is not part of the token */
+} Transition;
+
+#define GO(s) { s, ERROR, FALSE }
+#define ACCEPT(t) { DONE, t, FALSE }
+#define BACKUP(t) { DONE, t, TRUE }
+
+static const Transition transition[NUMSTATES][NUMCLASSES] = {
+    /* START */
+    {
+        ACCEPT(ERROR), GO(IN_ID), GO(IN_NUM), GO(START), GO(IN_ASSIGN), GO(IN_LT), GO(IN_GT),
+        GO(IN_NE), GO(IN_OVER), ACCEPT(TIMES), ACCEPT(PLUS), ACCEPT(MINUS), ACCEPT(LPAREN), ACCEPT(RPAREN),
+        ACCEPT(LBRACE), ACCEPT(RBRACE), ACCEPT(LBRACK), ACCEPT(RBRACK), ACCEPT(SEMI), ACCEPT(COMMA), ACCEPT(ENDFILE)
+    },
+    /* IN_ASSIGN */
+    {
+        BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), ACCEPT(EQ), BACKUP(ASSIGN), BACKUP(ASSIGN),
+        BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN),
+        BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN), BACKUP(ASSIGN)
+    },
+    /* IN_COMMENT */
+    {
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT),
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT_STAR), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT),
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), ACCEPT(STOP_BEFORE_END)
+    },
+    /* IN_NUM */
+    {
+        BACKUP(NUM), BACKUP(NUM), GO(IN_NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM),
+        BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM),
+        BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM), BACKUP(NUM)
+    },
+    /* IN_ID */
+    {
+        BACKUP(ID), GO(IN_ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID),
+        BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID),
+        BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID), BACKUP(ID)
+    },
+    /* DONE (never read) */
+    {
+        ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR),
+        ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR),
+        ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR), ACCEPT(ERROR)
+    },
+    /* IN_LT */
+    {
+        BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), ACCEPT(LTE), BACKUP(LT), BACKUP(LT),
+        BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT),
+        BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT), BACKUP(LT)
+    },
+    /* IN_GT */
+    {
+        BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), ACCEPT(GTE), BACKUP(GT), BACKUP(GT),
+        BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT),
+        BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT), BACKUP(GT)
+    },
+    /* IN_NE */
+    {
+        BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), ACCEPT(NE), BACKUP(ERROR), BACKUP(ERROR),
+        BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR),
+        BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR), BACKUP(ERROR)
+    },
+    /* IN_OVER */
+    {
+        BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER),
+        BACKUP(OVER), BACKUP(OVER), GO(IN_COMMENT), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER),
+        BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER), BACKUP(OVER)
+    },
+    /* IN_COMMENT_STAR */
+    {
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT),
+        GO(IN_COMMENT), GO(START), GO(IN_COMMENT_STAR), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT),
+        GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), GO(IN_COMMENT), ACCEPT(STOP_BEFORE_END)
+    },
+};
+
+#undef GO
+#undef ACCEPT
+#undef BACKUP
+
+
 /****************************************/
 /* the primary function of the scanner  */
 /****************************************/
-/* function getToken returns the next token in source file */
+/* function scanToken returns the next token in source file.
+   It runs the transition table one character at a time;
+   the fast paths take over inside blanks, comments and ID/NUM runs.
+   echo and trace stand for EchoSource and TraceScan. They are
+   always constants, so each call (see getToken) is a copy of the
+   scanner with the checks for them folded away */
 
-TokenType getToken()
-{  /* index for storing into tokenString */
-    int tokenStringIndex = 0;
+ALWAYS_INLINE TokenType scanToken(int echo, int trace)
+{  /* start of the current lexeme in srcBuf */
+    size_t tokStart = srcPos;
     /* holds current token to be returned */
-    TokenType currentToken; //리턴되어질 현재토큰
-    /* current state - always begins at START */
-    StateType state = START;
-    /* flag to indicate save to tokenString */
-    int save;
+    TokenType currentToken = ERROR; //리턴되어질 현재토큰
+    /* current state - begins at START unless resuming inside a comment */
+    StateType state = resumeState;
+    size_t len;
+    resumeState = START;
     while (state != DONE)  // state가 DONE이 아니라면 계속 돌아감
     {
-        int c = getNextChar();
-        save = TRUE;
+        int c = getNextChar(echo);
+        const Transition* t = &transition[state][(c == EOF) ? CC_EOF : charClass[c]];
+        if (state == START && c != EOF)
+            tokStart = srcPos - 1; // 공백, comment가 끝난 뒤 새 lexeme 시작
+        if (t->unget)
+            ungetNextChar();
+        state = (StateType)t->next;
+        currentToken = (TokenType)t->token;
         switch (state) {
         case START:
-            if (isdigit(c))
-                state = IN_NUM;
-            else if (isalpha(c))
-                state = IN_ID;
-
-            /* White space consists of blanks, newlines, and tabs
-               White space is ignored except that it must separate ID’s, NUM’s, and
-               keywords.*/
-            else if ((c == ' ') || (c == '\t') || (c == '\n')) {
-                save = FALSE;
-            }
-            else if (c == '=') {
-                save = FALSE;
-                state = IN_ASSIGN;
-            }
-            else if (c == '<') {
-                save = FALSE;
-                state = IN_LT;
+            srcPos = skipBlanks(srcPos, lineEnd);
+            break;
+        case IN_COMMENT:
+            srcPos = findStar(srcPos, lineEnd);
+            break;
+        case IN_ID:
+            srcPos = spanLetters(srcPos, lineEnd);
+            break;
+        case IN_NUM:
+            srcPos = spanDigits(srcPos, lineEnd);
+            break;
+        default:
+            break;
+        }
+    }
+    /* the lexeme is srcBuf[tokStart, srcPos) */
+    if (currentToken == ENDFILE || currentToken == STOP_BEFORE_END)
+        len = 0;
+    else
+        len = srcPos - tokStart;
+    tokenString = srcBuf + tokStart;
+    tokenOffset = tokStart;
+    tokenLength = len;
+    if (currentToken == ID)
+        currentToken = reservedLookup(srcBuf + tokStart, srcPos - tokStart);
+    if (trace) {
+        outChar('\t');
+        outInt(lineno, 0);
+        outText(": ");
+        printToken(currentToken, tokenString, tokenLength);
+    }
+    return currentToken;
+} /* end scanToken */
+
+/* getTokenQuiet is getToken with EchoSource and TraceScan off,
+   for callers that never echo or trace */
+TokenType getTokenQuiet(void)
+{
+    return scanToken(FALSE, FALSE);
+}
+
+/* getToken returns the next token, echoing and tracing as
+   EchoSource and TraceScan say. The flags are looked at once a
+   token, never inside the scanning loop */
+TokenType getToken(void)
+{
+#ifdef NOTRACE
+    return getTokenQuiet();
+#else
+    if (EchoSource)
+        return TraceScan ? scanToken(TRUE, TRUE) : scanToken(TRUE, FALSE);
+    return TraceScan ? scanToken(FALSE, TRUE) : getTokenQuiet();
+#endif
+}
+
+/* growTokens makes room for at least one more token in tb.
+   returns FALSE when out of memory */
+static int growTokens(TokenBuffer* tb)
+{
+    int cap = (tb->capacity == 0) ? 1024 : tb->capacity * 2;
+    unsigned char* kind = (unsigned char*)realloc(tb->kind, cap * sizeof(unsigned char));
+    size_t* offset = (size_t*)realloc(tb->offset, cap * sizeof(size_t));
+    int* length = (int*)realloc(tb->length, cap * sizeof(int));
+    int* line = (int*)realloc(tb->line, cap * sizeof(int));
+    if (kind != NULL) tb->kind = kind;
+    if (offset != NULL) tb->offset = offset;
+    if (length != NULL) tb->length = length;
+    if (line != NULL) tb->line = line;
+    if (kind == NULL || offset == NULL || length == NULL || line == NULL) {
+        fprintf(listing, "Out of memory error at line %d\n", lineno);
+        return FALSE;
+    }
+    tb->capacity = cap;
+    return TRUE;
+}
+
+/* scanTokens appends up to maxTokens tokens (the rest of the
+   source if maxTokens <= 0) to tb, stopping after ENDFILE.
+   It never echoes or traces. returns the number of tokens appended */
+int scanTokens(TokenBuffer* tb, int maxTokens)
+{
+    int n = 0;
+    TokenType tok;
+    do {
+        if (tb->count == tb->capacity && !growTokens(tb))
+            break;
+        tok = getTokenQuiet();
+        tb->kind[tb->count] = (unsigned char)tok;
+        tb->offset[tb->count] = tokenOffset;
+        tb->length[tb->count] = (int)tokenLength;
+        tb->line[tb->count] = lineno;
+        tb->count++;
+        n++;
+    } while (tok != ENDFILE && n != maxTokens);
+    return n;
+}
+
+/* freeTokens releases the arrays of tb */
+void freeTokens(TokenBuffer* tb)
+{
+    free(tb->kind);
+    free(tb->offset);
+    free(tb->length);
+    free(tb->line);
+    tb->kind = NULL;
+    tb->offset = NULL;
+    tb->length = NULL;
+    tb->line = NULL;
+    tb->count = tb->capacity = 0;
+}
+
+////////////////////////////////////////////////// TOKFILE.C 파일 ///////////////////////////////////////////
+/*
+Binary token files (scan -b), so that later tools get the tokens
+without parsing the text listing back. Layout:
+
+    header   "CMTK", TOKVERSION, 3 zero bytes, then little-endian
+             64-bit token count, lexeme table size and stream size
+    lexemes  every distinct lexeme once: varint length, then the bytes
+    tokens   for each token: varint kind, varint line delta from the
+             previous token and, for tokens that carry a lexeme
+             (reserved words, ID, NUM, ERROR), the varint offset of
+             its entry in the lexeme table
+
+Varints are LEB128 (7 bits per byte, low bits first). Nothing in the
+file is a pointer, so a reader maps it (mapSource) and walks it in
+place with nextTokenRecord.
+*/
+
+#define TOKMAGIC "CMTK"
+#define TOKVERSION 1
+#define TOKHEADER 32 /* size of the file header in bytes */
+
+/* ByteBuf is a growable byte array */
+typedef struct {
+    unsigned char* data;
+    size_t len;
+    size_t cap;
+} ByteBuf;
+
+/* LexemeSlot is one entry of the lexeme intern table. The
+   lexeme is compared against its copy in the table, so callers
+   may pass lexemes that do not outlive the call */
+typedef struct {
+    size_t hash;
+    size_t offset; /* position of the entry in the lexeme table */
+    size_t bytes; /* position of its bytes (0 for an empty slot) */
+    size_t len;
+} LexemeSlot;
+
+/* TokenWriter collects tokens for a binary token file */
+typedef struct {
+    ByteBuf lexemes; /* the lexeme table */
+    ByteBuf stream; /* the encoded tokens */
+    LexemeSlot* slots; /* open addressing, a power of two in size */
+    size_t nslots;
+    size_t nused;
+    unsigned long long count; /* number of tokens written */
+    int lastLine; /* line of the previous token */
+    int failed; /* TRUE once out of memory */
+} TokenWriter;
+
+/* tokHasLexeme is TRUE for tokens whose spelling is not fixed
+   by their kind, i.e. the ones printToken prints a lexeme for */
+static int tokHasLexeme(TokenType t)
+{
+    return (t >= ELSE && t <= WHILE) || t == ID || t == NUM || t == ERROR;
+}
+
+/* bufReserve makes room for n more bytes in b.
+   returns FALSE when out of memory */
+static int bufReserve(ByteBuf* b, size_t n)
+{
+    size_t cap = b->cap;
+    unsigned char* grown;
+    if (b->len + n <= cap)
+        return TRUE;
+    if (cap == 0) cap = 4096;
+    while (cap < b->len + n) cap *= 2;
+    grown = (unsigned char*)realloc(b->data, cap);
+    if (grown == NULL)
+        return FALSE;
+    b->data = grown;
+    b->cap = cap;
+    return TRUE;
+}
+
+/* putVarint appends v to b as a LEB128 varint (room for 10 bytes is reserved) */
+static void putVarint(ByteBuf* b, unsigned long long v)
+{
+    while (v >= 0x80) {
+        b->data[b->len++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    b->data[b->len++] = (unsigned char)v;
+}
+
+/* hashLexeme is FNV-1a over the bytes of a lexeme */
+static size_t hashLexeme(const char* s, size_t len)
+{
+    size_t h = 2166136261u;
+    size_t i;
+    for (i = 0; i < len; i++)
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    return h;
+}
+
+/* internLexeme returns the offset of the lexeme in the lexeme table,
+   adding it on first use. returns (size_t)-1 when out of memory */
+static size_t internLexeme(TokenWriter* w, const char* s, size_t len)
+{
+    size_t h = hashLexeme(s, len);
+    size_t i;
+    if (2 * (w->nused + 1) > w->nslots) {
+        /* keep the table at most half full */
+        size_t n = (w->nslots == 0) ? 1024 : w->nslots * 2;
+        LexemeSlot* slots = (LexemeSlot*)calloc(n, sizeof(LexemeSlot));
+        if (slots == NULL)
+            return (size_t)-1;
+        for (i = 0; i < w->nslots; i++) {
+            if (w->slots[i].bytes != 0) {
+                size_t j = w->slots[i].hash & (n - 1);
+                while (slots[j].bytes != 0) j = (j + 1) & (n - 1);
+                slots[j] = w->slots[i];
             }
-            else if (c == '>') {
-                save = FALSE;
-                state = IN_GT;
+        }
+        free(w->slots);
+        w->slots = slots;
+        w->nslots = n;
+    }
+    i = h & (w->nslots - 1);
+    while (w->slots[i].bytes != 0) {
+        if (w->slots[i].hash == h && w->slots[i].len == len
+            && memcmp(w->lexemes.data + w->slots[i].bytes, s, len) == 0)
+            return w->slots[i].offset;
+        i = (i + 1) & (w->nslots - 1);
+    }
+    if (!bufReserve(&w->lexemes, 10 + len))
+        return (size_t)-1;
+    w->slots[i].hash = h;
+    w->slots[i].len = len;
+    w->slots[i].offset = w->lexemes.len;
+    w->nused++;
+    putVarint(&w->lexemes, len);
+    w->slots[i].bytes = w->lexemes.len;
+    memcpy(w->lexemes.data + w->lexemes.len, s, len);
+    w->lexemes.len += len;
+    return w->slots[i].offset;
+}
+
+/* tokWrite appends one token to w; the lexeme s is copied */
+void tokWrite(TokenWriter* w, TokenType t, int line, const char* s, size_t len)
+{
+    size_t off = 0;
+    if (w->failed)
+        return;
+    if (tokHasLexeme(t))
+        off = internLexeme(w, s, len);
+    if (off == (size_t)-1 || !bufReserve(&w->stream, 30)) {
+        w->failed = TRUE;
+        return;
+    }
+    putVarint(&w->stream, (unsigned)t);
+    putVarint(&w->stream, (unsigned)(line - w->lastLine));
+    if (tokHasLexeme(t))
+        putVarint(&w->stream, off);
+    w->lastLine = line;
+    w->count++;
+}
+
+/* putU64 stores v little-endian at p */
+static void putU64(unsigned char* p, unsigned long long v)
+{
+    int i;
+    for (i = 0; i < 8; i++)
+        p[i] = (unsigned char)(v >> (8 * i));
+}
+
+/* tokFinish writes the token file collected by w to fp and
+   releases w. returns FALSE if it could not be written */
+int tokFinish(TokenWriter* w, FILE* fp)
+{
+    unsigned char header[TOKHEADER] = { 0 };
+    int ok = !w->failed;
+    memcpy(header, TOKMAGIC, 4);
+    header[4] = TOKVERSION;
+    putU64(header + 8, w->count);
+    putU64(header + 16, w->lexemes.len);
+    putU64(header + 24, w->stream.len);
+    if (ok)
+        ok = fwrite(header, 1, TOKHEADER, fp) == TOKHEADER
+        && fwrite(w->lexemes.data, 1, w->lexemes.len, fp) == w->lexemes.len
+        && fwrite(w->stream.data, 1, w->stream.len, fp) == w->stream.len;
+    free(w->lexemes.data);
+    free(w->stream.data);
+    free(w->slots);
+    memset(w, 0, sizeof(*w));
+    return ok;
+}
+
+/* TokenFile is a binary token file image in memory */
+typedef struct {
+    const unsigned char* lexemes; /* the lexeme table */
+    size_t lexSize;
+    const unsigned char* tokens; /* the encoded tokens */
+    size_t tokSize;
+    unsigned long long count; /* number of tokens */
+} TokenFile;
+
+/* TokenCursor walks the tokens of a TokenFile */
+typedef struct {
+    size_t pos; /* next byte in the token stream */
+    unsigned long long left; /* tokens not read yet */
+    int line; /* line of the last token read */
+} TokenCursor;
+
+/* getU64 loads a little-endian 64-bit value from p */
+static unsigned long long getU64(const unsigned char* p)
+{
+    unsigned long long v = 0;
+    int i;
+    for (i = 7; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+/* getVarint decodes a varint at p[*pos] (p is size bytes long).
+   returns FALSE if it runs past the end or is too long */
+static int getVarint(const unsigned char* p, size_t size, size_t* pos, unsigned long long* v)
+{
+    int shift;
+    *v = 0;
+    for (shift = 0; shift < 64 && *pos < size; shift += 7) {
+        unsigned char b = p[(*pos)++];
+        *v |= (unsigned long long)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* openTokenFile checks the header of the image [data, data + size)
+   and sets up tf to read it in place. returns FALSE if it is not a
+   token file of this version */
+int openTokenFile(TokenFile* tf, const void* data, size_t size)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    unsigned long long lexSize, tokSize;
+    if (size < TOKHEADER || memcmp(p, TOKMAGIC, 4) != 0 || p[4] != TOKVERSION)
+        return FALSE;
+    lexSize = getU64(p + 16);
+    tokSize = getU64(p + 24);
+    if (lexSize > size - TOKHEADER || tokSize != size - TOKHEADER - lexSize)
+        return FALSE;
+    tf->count = getU64(p + 8);
+    tf->lexemes = p + TOKHEADER;
+    tf->lexSize = (size_t)lexSize;
+    tf->tokens = tf->lexemes + lexSize;
+    tf->tokSize = (size_t)tokSize;
+    return TRUE;
+}
+
+/* tokenCursor starts c at the first token of tf */
+void tokenCursor(const TokenFile* tf, TokenCursor* c)
+{
+    c->pos = 0;
+    c->left = tf->count;
+    c->line = 0;
+}
+
+/* nextTokenRecord reads the next token of tf into *t, *line and the
+   lexeme view (*s, *len) - the view points into the image.
+   returns FALSE after the last token or on a damaged record */
+int nextTokenRecord(const TokenFile* tf, TokenCursor* c, TokenType* t, int* line, const char** s, size_t* len)
+{
+    unsigned long long kind, delta, off, n;
+    size_t lexPos;
+    if (c->left == 0)
+        return FALSE;
+    if (!getVarint(tf->tokens, tf->tokSize, &c->pos, &kind) || kind > STOP_BEFORE_END
+        || !getVarint(tf->tokens, tf->tokSize, &c->pos, &delta))
+        return FALSE;
+    *s = "";
+    *len = 0;
+    if (tokHasLexeme((TokenType)kind)) {
+        if (!getVarint(tf->tokens, tf->tokSize, &c->pos, &off) || off >= tf->lexSize)
+            return FALSE;
+        lexPos = (size_t)off;
+        if (!getVarint(tf->lexemes, tf->lexSize, &lexPos, &n) || n > tf->lexSize - lexPos)
+            return FALSE;
+        *s = (const char*)tf->lexemes + lexPos;
+        *len = (size_t)n;
+    }
+    c->line += (int)delta;
+    c->left--;
+    *t = (TokenType)kind;
+    *line = c->line;
+    return TRUE;
+}
+
+/* writeTokens scans the rest of the source into w in batches
+   of TOKENCHUNK tokens */
+static void writeTokens(TokenWriter* w)
+{
+    TokenBuffer tb = { 0 };
+    int i, n;
+    do {
+        tb.count = 0;
+        n = scanTokens(&tb, TOKENCHUNK);
+        for (i = 0; i < tb.count; i++)
+            tokWrite(w, (TokenType)tb.kind[i], tb.line[i], srcBuf + tb.offset[i], tb.length[i]);
+    } while (n > 0 && tb.kind[tb.count - 1] != ENDFILE);
+    freeTokens(&tb);
+}
+
+/* listTokens prints the tokens of a token file the way
+   TraceScan prints them while scanning */
+static int listTokens(const TokenFile* tf)
+{
+    TokenCursor c;
+    TokenType t;
+    int line;
+    const char* s;
+    size_t len;
+    tokenCursor(tf, &c);
+    while (nextTokenRecord(tf, &c, &t, &line, &s, &len)) {
+        outChar('\t');
+        outInt(line, 0);
+        outText(": ");
+        printToken(t, s, len);
+    }
+    return c.left == 0;
+}
+
+////////////////////////////////////////////////// PSCAN.C 파일 ///////////////////////////////////////////
+/*
+Parallel scanning of large sources (scan -j). The source is cut into
+chunks at line starts and each chunk is scanned by getToken on its own
+thread into its own TokenBuffer; the scanner state is THREAD_LOCAL, and
+the end of a chunk looks like the end of the file to getToken.
+Every chunk is first scanned on the guess that it does not begin inside
+a comment. While the streams are stitched back together in order, a
+chunk whose predecessor ended inside a comment is scanned again from
+IN_COMMENT. Tokens never span a newline otherwise, so no other state
+can cross a seam. Line numbers are counted per chunk and offset while
+stitching, so the listing is the same as the sequential one.
+(link with -pthread)
+*/
+
+/* CHUNKMIN = smallest chunk worth a thread of its own */
+#define CHUNKMIN 65536
+
+typedef struct {
+    size_t start; /* the chunk is srcBuf[start, end) */
+    size_t end;
+    StateType startState; /* state the chunk was scanned from */
+    int inComment; /* the chunk ends inside a comment */
+    int lines; /* number of lines in the chunk */
+    int count; /* tokens of the chunk, without the chunk's ENDFILE */
+    TokenBuffer tokens; /* lines are relative to the chunk */
+} Chunk;
+
+/* scanChunk scans one chunk on the calling thread */
+static void scanChunk(Chunk* ck)
+{
+    int last;
+    srcPos = lineEnd = ck->start;
+    srcLen = ck->end;
+    EOF_flag = FALSE;
+    lineno = 0;
+    resumeState = ck->startState;
+    ck->tokens.count = 0;
+    scanTokens(&ck->tokens, 0);
+    last = ck->tokens.count - 1; /* ENDFILE */
+    ck->inComment = (last > 0 && ck->tokens.kind[last - 1] == STOP_BEFORE_END);
+    ck->count = ck->inComment ? last - 1 : last;
+    /* STOP_BEFORE_END or ENDFILE is read one line past the chunk */
+    ck->lines = ck->tokens.line[ck->count] - 1;
+}
+
+#ifdef _WIN32
+typedef HANDLE ChunkThread;
+static unsigned __stdcall chunkMain(void* arg) { scanChunk((Chunk*)arg); return 0; }
+static int startChunk(ChunkThread* th, Chunk* ck)
+{
+    *th = (HANDLE)_beginthreadex(NULL, 0, chunkMain, ck, 0, NULL);
+    return *th != 0;
+}
+static void joinChunk(ChunkThread th) { WaitForSingleObject(th, INFINITE); CloseHandle(th); }
+#else
+typedef pthread_t ChunkThread;
+static void* chunkMain(void* arg) { scanChunk((Chunk*)arg); return NULL; }
+static int startChunk(ChunkThread* th, Chunk* ck) { return pthread_create(th, NULL, chunkMain, ck) == 0; }
+static void joinChunk(ChunkThread th) { pthread_join(th, NULL); }
+#endif
+
+/* echoPos/echoLine track how much of the source has been echoed */
+static size_t echoPos = 0;
+static int echoLine = 0;
+
+/* echoThrough echoes the source lines up to line l, as getNextChar
+   would have done by the time a token of line l is returned */
+static void echoThrough(int l)
+{
+    while (echoLine < l && echoPos < srcLen) {
+        const char* nl = memchr(srcBuf + echoPos, '\n', srcLen - echoPos);
+        size_t end = (nl != NULL) ? (size_t)(nl - srcBuf) + 1 : srcLen;
+        echoLine++;
+        outInt(echoLine, 4);
+        outText(": ");
+        outSource(srcBuf + echoPos, end - echoPos);
+        echoPos = end;
+    }
+}
+
+/* scanParallel scans the whole source on up to nthreads threads and
+   writes the same listing as the sequential getToken loop, or hands
+   the tokens to out when writing a token file (out != NULL) */
+void scanParallel(int nthreads, TokenWriter* out)
+{
+    Chunk* chunks;
+    ChunkThread* threads;
+    int* started;
+    int n = 0, i, j, count, base = 0;
+    size_t pos = 0, size;
+
+    if ((size_t)nthreads > srcLen / CHUNKMIN + 1)
+        nthreads = (int)(srcLen / CHUNKMIN + 1);
+    chunks = (Chunk*)calloc(nthreads, sizeof(Chunk));
+    threads = (ChunkThread*)calloc(nthreads, sizeof(ChunkThread));
+    started = (int*)calloc(nthreads, sizeof(int));
+    if (chunks == NULL || threads == NULL || started == NULL) {
+        fprintf(stderr, "Out of memory error\n");
+        exit(1);
+    }
+    /* cut the source right after a newline near every 1/nthreads */
+    size = srcLen / nthreads;
+    do {
+        size_t end = (n == nthreads - 1 || srcLen - pos <= size) ? srcLen : pos + size;
+        if (end < srcLen) {
+            const char* nl = memchr(srcBuf + end, '\n', srcLen - end);
+            end = (nl != NULL) ? (size_t)(nl - srcBuf) + 1 : srcLen;
+        }
+        chunks[n].start = pos;
+        chunks[n].end = end;
+        chunks[n].startState = START;
+        n++;
+        pos = end;
+    } while (pos < srcLen && n < nthreads);
+
+    for (i = 0; i < n; i++)
+        started[i] = startChunk(&threads[i], &chunks[i]);
+
+    for (i = 0; i < n; i++) {
+        Chunk* ck = &chunks[i];
+        int guessWrong = (i > 0 && chunks[i - 1].inComment);
+        if (started[i])
+            joinChunk(threads[i]);
+        if (!started[i] || guessWrong) {
+            /* scan the chunk (again) on a fresh thread, since
+               scanChunk overwrites the caller's scanner state */
+            ChunkThread th;
+            if (guessWrong)
+                ck->startState = IN_COMMENT;
+            if (!startChunk(&th, ck)) {
+                fprintf(stderr, "Cannot start a scanning thread\n");
+                exit(1);
             }
-            else if (c == '!') {
-                save = FALSE;
-                state = IN_NE;
+            joinChunk(th);
+        }
+        /* only the last chunk keeps its STOP_BEFORE_END/ENDFILE */
+        count = (i == n - 1) ? ck->tokens.count : ck->count;
+        for (j = 0; j < count; j++) {
+            TokenType t = (TokenType)ck->tokens.kind[j];
+            int line = base + ck->tokens.line[j];
+            if (out != NULL) {
+                tokWrite(out, t, line, srcBuf + ck->tokens.offset[j], ck->tokens.length[j]);
+                continue;
             }
-            else if (c == '/') {
-                save = FALSE;
-                state = IN_OVER;
+            if (EchoSource) echoThrough(line);
+            if (TraceScan) {
+                outChar('\t');
+                outInt(line, 0);
+                outText(": ");
+                printToken(t, srcBuf + ck->tokens.offset[j], ck->tokens.length[j]);
             }
-            else {
-                state = DONE;
-                switch (c) {
-                case EOF:
-                    save = FALSE;
-                    currentToken = ENDFILE;
-                    break;
-                case '+':
-                    currentToken = PLUS;
-                    break;
-                case '-':
-                    currentToken = MINUS;
-                    break;
-                case '*':
-                    currentToken = TIMES;
-                    break;
-                case '(':
-                    currentToken = LPAREN;
-                    break;
-                case ')':
-                    currentToken = RPAREN;
-                    break;
-                case '{':
-                    currentToken = LBRACE;
-                    break;
-                case '}':
-                    currentToken = RBRACE;
-                    break;
-                case '[':
-                    currentToken = LBRACK;
-                    break;
-                case ']':
-                    currentToken = RBRACK;
-                    break;
-                case ';':
-                    currentToken = SEMI;
-                    break;
-                case ',':
-                    currentToken = COMMA;
-                    break;
-                default:
-                    currentToken = ERROR;
-                    break;
+        }
+        base += ck->lines;
+        freeTokens(&ck->tokens);
+    }
+    free(started);
+    free(threads);
+    free(chunks);
+}
+
+////////////////////////////////////////////////// PUSHSCAN.C 파일 ///////////////////////////////////////////
+/*
+Push-style scanning for input that arrives in pieces (scan - reads
+stdin). The caller hands arbitrary byte chunks to pushFeed and the
+lexer runs the same transition table as getToken over them, calling
+the sink for every finished token. A chunk may end anywhere - inside
+an ID or NUM, between the two characters of <=, >=, == or !=, or inside
+a comment - and the DFA state plus the bytes of the unfinished lexeme
+are kept in the PushLexer until the next chunk arrives. pushFinish
+plays the end of input the way getNextChar reports EOF.
+Line numbers follow getNextChar: a line is counted when its first
+character is read, and every read at EOF counts one more.
+*/
+
+/* STREAMCHUNK = largest number of bytes read from a stream at once */
+#define STREAMCHUNK 65536
+
+/* PushSink receives each token: kind, line and a view of the lexeme
+   that is only valid during the call */
+typedef void (*PushSink)(void* arg, TokenType token, int line, const char* s, size_t len);
+
+typedef struct {
+    StateType state; /* DFA state between chunks */
+    ByteBuf pending; /* the part of the current lexeme seen in earlier chunks */
+    int line; /* current line number */
+    int newLine; /* the next character starts a line */
+    PushSink sink;
+    void* arg; /* passed to sink */
+} PushLexer;
+
+/* pushInit starts a lexer that hands its tokens to sink */
+void pushInit(PushLexer* lx, PushSink sink, void* arg)
+{
+    memset(lx, 0, sizeof(*lx));
+    lx->state = START;
+    lx->newLine = TRUE;
+    lx->sink = sink;
+    lx->arg = arg;
+}
+
+/* pushEmit finishes the token that ends at data[end]; its first
+   bytes are in lx->pending if it began in an earlier chunk */
+static void pushEmit(PushLexer* lx, TokenType token, const char* data, size_t start, size_t end)
+{
+    const char* s = data + start;
+    size_t len = end - start;
+    if (lx->pending.len > 0) {
+        if (!bufReserve(&lx->pending, len)) {
+            fprintf(stderr, "Out of memory error at line %d\n", lx->line);
+            exit(1);
+        }
+        memcpy(lx->pending.data + lx->pending.len, s, len);
+        s = (const char*)lx->pending.data;
+        len = lx->pending.len + len;
+        lx->pending.len = 0;
+    }
+    if (token == ENDFILE || token == STOP_BEFORE_END)
+        len = 0;
+    if (token == ID)
+        token = reservedLookup(s, len);
+    lx->sink(lx->arg, token, lx->line, s, len);
+}
+
+/* pushFeed lexes the n bytes at data */
+void pushFeed(PushLexer* lx, const char* data, size_t n)
+{
+    size_t i = 0;
+    size_t start = 0; /* start of the current lexeme in data */
+    while (i < n) {
+        unsigned char c = (unsigned char)data[i];
+        const Transition* t = &transition[lx->state][charClass[c]];
+        if (lx->newLine) {
+            lx->line++;
+            lx->newLine = FALSE;
+        }
+        if (lx->state == START)
+            start = i;
+        if (!t->unget) {
+            i++;
+            if (c == '\n') lx->newLine = TRUE;
+        }
+        if (t->next == DONE) {
+            pushEmit(lx, (TokenType)t->token, data, start, i);
+            lx->state = START;
+        }
+        else {
+            lx->state = (StateType)t->next;
+            /* comment bodies only matter at a '*' (or a newline);
+               a '/' kept from the last chunk was the comment's opening */
+            if (lx->state == IN_COMMENT) {
+                lx->pending.len = 0;
+                /* the skipped bytes may be the first of a line */
+                if (lx->newLine && i < n) {
+                    lx->line++;
+                    lx->newLine = FALSE;
                 }
+                while (i < n && data[i] != '*' && data[i] != '\n') i++;
             }
+        }
+    }
+    /* keep the unfinished lexeme for the next chunk */
+    if (lx->state != START && lx->state != IN_COMMENT && lx->state != IN_COMMENT_STAR) {
+        if (!bufReserve(&lx->pending, n - start)) {
+            fprintf(stderr, "Out of memory error at line %d\n", lx->line);
+            exit(1);
+        }
+        memcpy(lx->pending.data + lx->pending.len, data + start, n - start);
+        lx->pending.len += n - start;
+    }
+}
+
+/* pushFinish ends the input: it finishes the pending token and
+   hands out the tokens getToken returns at EOF, ENDFILE last */
+void pushFinish(PushLexer* lx)
+{
+    for (;;) {
+        const Transition* t = &transition[lx->state][CC_EOF];
+        /* every read at EOF counts a line, as in getNextChar; the
+           first of them is the line a pending newLine announced */
+        lx->line++;
+        lx->newLine = FALSE;
+        if (t->next != DONE) { /* cannot happen: every state ends at EOF */
+            lx->state = (StateType)t->next;
+            continue;
+        }
+        pushEmit(lx, (TokenType)t->token, "", 0, 0);
+        lx->state = START;
+        if (t->token == ENDFILE)
             break;
+    }
+    free(lx->pending.data);
+    lx->pending.data = NULL;
+    lx->pending.cap = 0;
+}
+
+/* streamToken is the sink of scanStream: it writes the token
+   to the token file arg, or lists it if arg is NULL */
+static void streamToken(void* arg, TokenType token, int line, const char* s, size_t len)
+{
+    if (arg != NULL)
+        tokWrite((TokenWriter*)arg, token, line, s, len);
+    else if (TraceScan) {
+        outChar('\t');
+        outInt(line, 0);
+        outText(": ");
+        printToken(token, s, len);
+    }
+}
 
-        case IN_ASSIGN: // ASSIGN으로 시작하는데 equal인지 assign인지 구분
-            state = DONE;
-            if (c == '=') // '==' 즉, eqaul이므로 TOKEN은 EQ
-                currentToken = EQ;
-            else { // '=' 하나이므로 ASSIGN 토큰
-                currentToken = ASSIGN;
-                ungetNextChar();
+/* readSome reads whatever is available from fp (at most n bytes)
+   without waiting for a full buffer. returns 0 at end of input */
+static size_t readSome(FILE* fp, char* buf, size_t n)
+{
+#ifdef _WIN32
+    int got = _read(_fileno(fp), buf, (unsigned)n);
+#else
+    ssize_t got;
+    do got = read(fileno(fp), buf, n); while (got < 0 && errno == EINTR);
+#endif
+    return (got > 0) ? (size_t)got : 0;
+}
+
+/* scanStream scans fp as it arrives. With EchoSource on, the bytes
+   are fed a line at a time so that each line is echoed before its
+   tokens, the way getNextChar does it */
+void scanStream(FILE* fp, TokenWriter* out)
+{
+    PushLexer lx;
+    ByteBuf carry = { 0 }; /* unfinished line (echo only) */
+    int echoLine = 0;
+    int echo = EchoSource && out == NULL;
+    char* buf = (char*)malloc(STREAMCHUNK);
+    size_t n;
+    if (buf == NULL) {
+        fprintf(stderr, "Out of memory error\n");
+        exit(1);
+    }
+    pushInit(&lx, streamToken, out);
+    while ((n = readSome(fp, buf, STREAMCHUNK)) > 0) {
+        size_t pos = 0;
+        if (!echo) {
+            pushFeed(&lx, buf, n);
+            continue;
+        }
+        while (pos < n) {
+            const char* nl = memchr(buf + pos, '\n', n - pos);
+            size_t end = (nl != NULL) ? (size_t)(nl - buf) + 1 : n;
+            if (!bufReserve(&carry, end - pos)) {
+                fprintf(stderr, "Out of memory error\n");
+                exit(1);
             }
-            break;
-        case IN_COMMENT:
-            save = FALSE;
-            if (c == '*') {
-                c = getNextChar();
-                if (c == '/') { // '*/' 로 Comment 닫음.
-                    state = START;
-                }
-                else if (c == EOF) { // IN_COMMENT안에서  '*'에서 '/' 없이 파일을 다 읽었다면
-                    state = DONE;
-                    currentToken = STOP_BEFORE_END;
-                }
-                /* backup in the input */
-                else { //버퍼위치를 다시 직전으로 되돌려 그 값으로 처리할 수 있게 함.
-                    ungetNextChar();
-                }
+            if (nl == NULL || carry.len > 0) {
+                memcpy(carry.data + carry.len, buf + pos, end - pos);
+                carry.len += end - pos;
             }
-            else if (c == EOF) { // IN_COMMENT 상태에서 EOF가 되면,
-                state = DONE;
-                currentToken = STOP_BEFORE_END;
+            if (nl != NULL) {
+                const char* text = (carry.len > 0) ? (const char*)carry.data : buf + pos;
+                size_t len = (carry.len > 0) ? carry.len : end - pos;
+                outInt(++echoLine, 4);
+                outText(": ");
+                outChars(text, len);
+                pushFeed(&lx, text, len);
+                carry.len = 0;
             }
-            break;
+            pos = end;
+        }
+    }
+    if (carry.len > 0) {
+        outInt(++echoLine, 4);
+        outText(": ");
+        outChars((const char*)carry.data, carry.len);
+        pushFeed(&lx, (const char*)carry.data, carry.len);
+    }
+    pushFinish(&lx);
+    free(carry.data);
+    free(buf);
+}
 
-        case IN_NUM:
-            if (!isdigit(c)) { /* backup in the input */
-                ungetNextChar();
-                save = FALSE;
-                state = DONE;
-                currentToken = NUM;
-            }
-            break;
+////////////////////////////////////////////////// RELEX.C 파일 ///////////////////////////////////////////
+/*
+Incremental re-lexing after an edit, for editors that keep the token
+stream of a file in a TokenBuffer. An edit replaces `removed` bytes at
+`offset` by `inserted` bytes. Only the tokens around it are scanned
+again:
+ - scanning restarts at the end of the last token that ends before the
+   edit. getToken is always in START after a token, never inside a
+   comment, and that token's one character of lookahead is unchanged,
+   so everything before the restart point stays as it was.
+ - scanning stops at the first new token that starts where an old
+   token after the edit starts (shifted by the size of the edit). From
+   there on the text and the state are the same as before, so the old
+   tokens are kept and only their offsets and lines are moved.
+An edit that opens or closes a comment re-scans as far as the change
+of meaning reaches, up to the end of the file.
+*/
 
-        case IN_ID:                             /* backup in the input */
-            if (!(isalpha(c))) { //  IN_ID state에서는 letter letter* 을 받는다.
-                ungetNextChar();
-                save = FALSE;
-                state = DONE;
-                currentToken = ID;
-            }
-            break;
+/* applyEdit returns a new malloc'd copy of old (oldLen bytes) with
+   removed bytes at offset replaced by the insLen bytes at ins.
+   *newLen is set to its length. returns NULL when out of memory */
+char* applyEdit(const char* old, size_t oldLen, size_t offset, size_t removed,
+    const char* ins, size_t insLen, size_t* newLen)
+{
+    char* text = (char*)malloc(oldLen - removed + insLen + 1);
+    if (text == NULL)
+        return NULL;
+    memcpy(text, old, offset);
+    memcpy(text + offset, ins, insLen);
+    memcpy(text + offset + insLen, old + offset + removed, oldLen - offset - removed);
+    *newLen = oldLen - removed + insLen;
+    text[*newLen] = '\0';
+    return text;
+}
 
-        case IN_LT: // LT로 시작하는데 '<='인지 '<' 인지 구분
-            state = DONE;
-            if (c == '=') // '<='
-                currentToken = LTE;
-            else { // '<'
-                currentToken = LT;
-                ungetNextChar();
-            }
-            break;
+/* relexTokens updates tb, the complete token stream (ending with
+   ENDFILE) of the text before the edit, to the tokens of text[0, len),
+   the text after it. returns the number of tokens scanned again,
+   or -1 when out of memory (tb is left unchanged then) */
+int relexTokens(TokenBuffer* tb, const char* text, size_t len, size_t offset, size_t removed, size_t inserted)
+{
+    TokenBuffer fresh = { 0 };
+    const char* savedBuf = srcBuf;
+    size_t savedLen = srcLen;
+    long long delta = (long long)inserted - (long long)removed;
+    int lo = 0, hi = tb->count; /* tokens [0, lo) end before offset */
+    int keep, j, tail, count, lineDelta = 0, aligned = FALSE;
+    TokenType tok;
 
-        case IN_GT: // GT로 시작하는데 '>='인지 '>' 인지 구분
-            state = DONE;
-            if (c == '=') // '>='
-                currentToken = GTE;
-            else { // '>'
-                currentToken = GT;
-                ungetNextChar();
-            }
-            break;
+    /* binary search for the last token ending strictly before offset */
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (tb->kind[mid] != ENDFILE && tb->kind[mid] != STOP_BEFORE_END
+            && tb->offset[mid] + tb->length[mid] < offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    keep = lo;
 
-        case IN_NE: // !로 시작하는데 '!='가 아니라면 ERROR
-            state = DONE;
-            if (c == '=') // NOT EQUAL(!=)
-                currentToken = NE;
-            else if (c == '/') {
-                c = lineBuf[linepos - 2]; // c= '!'
-                currentToken = ERROR;
-                ungetNextChar();
-            }
-            else { // ERROR
-                currentToken = ERROR;
-                ungetNextChar();
-            }
-            break;
+    srcBuf = text;
+    srcLen = len;
+    EOF_flag = FALSE;
+    resumeState = START;
+    if (keep == 0) {
+        srcPos = lineEnd = 0;
+        lineno = 0;
+    }
+    else {
+        const char* nl;
+        srcPos = tb->offset[keep - 1] + tb->length[keep - 1];
+        nl = memchr(text + srcPos, '\n', len - srcPos);
+        lineEnd = (nl != NULL) ? (size_t)(nl - text) + 1 : len;
+        lineno = tb->line[keep - 1];
+    }
 
-            /*comments cannot be placed within tokens) and may include than one
-            line. Comments may not be nested.*/
-        case IN_OVER: // OVER로 시작하는데 Comment인지 나누기인지 구분
-            if (c == '*') { // comment left '/*'
-                state = IN_COMMENT;
-                save = FALSE;
-            }
-            else { // '*'이 안나왔다면 OVER만, 즉 '/'를 표현 -> 나누기 기호
-                ungetNextChar();
-                state = DONE;
-                currentToken = OVER;
+    /* old tokens from j on start at or after the end of the edit */
+    j = keep;
+    while (j < tb->count && tb->kind[j] != ENDFILE && tb->offset[j] < offset + removed)
+        j++;
+
+    do {
+        if (fresh.count == fresh.capacity && !growTokens(&fresh)) {
+            freeTokens(&fresh);
+            srcBuf = savedBuf;
+            srcLen = savedLen;
+            return -1;
+        }
+        tok = getTokenQuiet();
+        if (tok != ENDFILE && tok != STOP_BEFORE_END) {
+            while (j < tb->count && tb->kind[j] != ENDFILE && tb->kind[j] != STOP_BEFORE_END
+                && (long long)tb->offset[j] + delta < (long long)tokenOffset)
+                j++;
+            if (j < tb->count && tb->kind[j] != ENDFILE && tb->kind[j] != STOP_BEFORE_END
+                && (long long)tb->offset[j] + delta == (long long)tokenOffset) {
+                aligned = TRUE;
+                lineDelta = lineno - tb->line[j];
+                break;
             }
+        }
+        fresh.kind[fresh.count] = (unsigned char)tok;
+        fresh.offset[fresh.count] = tokenOffset;
+        fresh.length[fresh.count] = (int)tokenLength;
+        fresh.line[fresh.count] = lineno;
+        fresh.count++;
+    } while (tok != ENDFILE);
+
+    srcBuf = savedBuf;
+    srcLen = savedLen;
+
+    /* splice: tb[0, keep) + fresh + the old tokens from j on, moved */
+    tail = aligned ? tb->count - j : 0;
+    count = keep + fresh.count + tail;
+    while (tb->capacity < count) {
+        if (!growTokens(tb)) {
+            freeTokens(&fresh);
+            return -1;
+        }
+    }
+    if (tail > 0 && j != keep + fresh.count) {
+        memmove(tb->kind + keep + fresh.count, tb->kind + j, tail * sizeof(unsigned char));
+        memmove(tb->offset + keep + fresh.count, tb->offset + j, tail * sizeof(size_t));
+        memmove(tb->length + keep + fresh.count, tb->length + j, tail * sizeof(int));
+        memmove(tb->line + keep + fresh.count, tb->line + j, tail * sizeof(int));
+    }
+    for (j = keep + fresh.count; j < count; j++) {
+        tb->offset[j] = (size_t)((long long)tb->offset[j] + delta);
+        tb->line[j] += lineDelta;
+    }
+    memcpy(tb->kind + keep, fresh.kind, fresh.count * sizeof(unsigned char));
+    memcpy(tb->offset + keep, fresh.offset, fresh.count * sizeof(size_t));
+    memcpy(tb->length + keep, fresh.length, fresh.count * sizeof(int));
+    memcpy(tb->line + keep, fresh.line, fresh.count * sizeof(int));
+    tb->count = count;
+    count = fresh.count;
+    freeTokens(&fresh);
+    return count;
+}
+
+////////////////////////////////////////////////// BENCH.C 파일 ///////////////////////////////////////////
+/*
+Scanner benchmark (scan -B) and corpus generator (scan -G). The corpora
+are synthetic C- text of a given size and shape, made by a fixed-seed
+generator, so every run of every build scans the same bytes:
+
+    ids        declarations and assignments with long identifiers
+    comments   mostly block comments, several lines each
+    ops        operator-dense expressions without blanks
+    longlines  statements run together into lines of about 8 KB
+    mixed      ordinary functions with a comment now and then
+
+scan -B drives getTokenQuiet in-process over a corpus held in memory
+and keeps the best of several runs. It prints one tab-separated line
+per shape under a header line:
+
+    shape bytes lines tokens seconds tokens_per_s mb_per_s cycles_per_byte
+
+cycles_per_byte counts time-stamp counter ticks (0 where there is
+none). scan -G writes the same corpus to a file for timing by hand.
+*/
+
+#define BENCHSEED 0x9E3779B97F4A7C15ULL
+#define BENCHRUNS 5 /* default number of runs, the best one is reported */
+
+#ifdef _WIN32
+/* benchNow returns a monotonic time in seconds */
+static double benchNow(void)
+{
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+#else
+static double benchNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define benchCycles() __rdtsc()
+#elif defined(__x86_64__) || defined(__i386__)
+#define benchCycles() __rdtsc()
+#else
+#define benchCycles() 0ULL
+#endif
+
+/* benchRand is xorshift64* over the generator state *s */
+static unsigned long long benchRand(unsigned long long* s)
+{
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 2685821657736338717ULL;
+}
+
+/* benchPick returns a number in [lo, hi] */
+static int benchPick(unsigned long long* s, int lo, int hi)
+{
+    return lo + (int)((benchRand(s) >> 33) % (unsigned)(hi - lo + 1));
+}
+
+/* putText appends the string s to b. returns FALSE when out of memory */
+static int putText(ByteBuf* b, const char* s)
+{
+    size_t n = strlen(s);
+    if (!bufReserve(b, n))
+        return FALSE;
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    return TRUE;
+}
+
+/* putName appends a random identifier of lo to hi letters */
+static int putName(ByteBuf* b, unsigned long long* s, int lo, int hi)
+{
+    int n = benchPick(s, lo, hi);
+    if (!bufReserve(b, n))
+        return FALSE;
+    while (n-- > 0) {
+        int c = benchPick(s, 0, 51);
+        b->data[b->len++] = (char)((c < 26) ? 'a' + c : 'A' + c - 26);
+    }
+    return TRUE;
+}
+
+/* putNum appends a random number of up to 9 digits */
+static int putNum(ByteBuf* b, unsigned long long* s)
+{
+    char num[16];
+    sprintf(num, "%d", benchPick(s, 0, (benchPick(s, 0, 3) == 0) ? 999999999 : 999));
+    return putText(b, num);
+}
+
+/* putOperand appends an identifier, a number or an array element */
+static int putOperand(ByteBuf* b, unsigned long long* s, int lo, int hi)
+{
+    switch (benchPick(s, 0, 5)) {
+    case 0:
+        return putNum(b, s);
+    case 1:
+        return putName(b, s, lo, hi) && putText(b, "[") && putName(b, s, 1, 2) && putText(b, "]");
+    default:
+        return putName(b, s, lo, hi);
+    }
+}
+
+/* putExpr appends an expression of n operands; sep goes around operators */
+static int putExpr(ByteBuf* b, unsigned long long* s, int n, const char* sep, int lo, int hi)
+{
+    static const char* const ops[] = { "+", "-", "*", "/", "<", "<=", ">", ">=", "==", "!=" };
+    int ok = putOperand(b, s, lo, hi);
+    while (ok && --n > 0) {
+        int paren = (n > 2 && benchPick(s, 0, 4) == 0);
+        ok = putText(b, sep) && putText(b, ops[benchPick(s, 0, 9)]) && putText(b, sep)
+            && (!paren || putText(b, "(")) && putOperand(b, s, lo, hi);
+        if (ok && paren) {
+            ok = putText(b, sep) && putText(b, ops[benchPick(s, 0, 3)]) && putText(b, sep)
+                && putOperand(b, s, lo, hi) && putText(b, ")");
+            n--;
+        }
+    }
+    return ok;
+}
+
+/* putComment appends a block comment of the given number of lines */
+static int putComment(ByteBuf* b, unsigned long long* s, int lines)
+{
+    int ok = putText(b, "/*");
+    while (ok && lines-- > 0) {
+        int words = benchPick(s, 4, 12);
+        while (ok && words-- > 0)
+            ok = putText(b, " ") && putName(b, s, 1, 9) && (benchPick(s, 0, 9) != 0 || putText(b, (benchPick(s, 0, 1) == 0) ? " * 2," : " / x."));
+        ok = ok && putText(b, (lines > 0) ? "\n  *" : " */\n");
+    }
+    return ok;
+}
+
+static int genIds(ByteBuf* b, unsigned long long* s)
+{
+    if (benchPick(s, 0, 2) == 0)
+        return putText(b, "int ") && putName(b, s, 8, 24) && putText(b, ";\n");
+    return putText(b, "    ") && putName(b, s, 8, 24) && putText(b, " = ")
+        && putExpr(b, s, benchPick(s, 1, 4), " ", 8, 24) && putText(b, ";\n");
+}
+
+static int genComments(ByteBuf* b, unsigned long long* s)
+{
+    if (benchPick(s, 0, 4) == 0)
+        return putText(b, "    ") && putName(b, s, 1, 6) && putText(b, " = ")
+            && putExpr(b, s, 3, " ", 1, 6) && putText(b, ";\n");
+    return putComment(b, s, benchPick(s, 1, 8));
+}
+
+static int genOps(ByteBuf* b, unsigned long long* s)
+{
+    if (benchPick(s, 0, 3) == 0)
+        return putText(b, "if(") && putExpr(b, s, benchPick(s, 4, 10), "", 1, 2)
+            && putText(b, "){") && putName(b, s, 1, 2) && putText(b, "=") && putExpr(b, s, 6, "", 1, 2)
+            && putText(b, ";}else{return(") && putExpr(b, s, 4, "", 1, 2) && putText(b, ");}\n");
+    return putName(b, s, 1, 2) && putText(b, "=") && putExpr(b, s, benchPick(s, 6, 16), "", 1, 2)
+        && putText(b, ";\n");
+}
+
+static int genLongLines(ByteBuf* b, unsigned long long* s)
+{
+    size_t start = b->len;
+    int ok = TRUE;
+    while (ok && b->len - start < 8192)
+        ok = putName(b, s, 2, 10) && putText(b, " = ") && putExpr(b, s, benchPick(s, 2, 6), " ", 2, 10)
+            && putText(b, "; ");
+    return ok && putText(b, "\n");
+}
+
+static int genMixed(ByteBuf* b, unsigned long long* s)
+{
+    int stmts = benchPick(s, 2, 8);
+    int ok = (benchPick(s, 0, 3) != 0 || putComment(b, s, benchPick(s, 1, 3)))
+        && putText(b, (benchPick(s, 0, 1) == 0) ? "int " : "void ") && putName(b, s, 3, 10)
+        && putText(b, "(int ") && putName(b, s, 1, 6) && putText(b, ", int ") && putName(b, s, 1, 6)
+        && putText(b, "[])\n{\n    int ") && putName(b, s, 1, 6) && putText(b, ";\n");
+    while (ok && stmts-- > 0) {
+        switch (benchPick(s, 0, 4)) {
+        case 0:
+            ok = putText(b, "    while (") && putExpr(b, s, 3, " ", 1, 6) && putText(b, ") {\n        ")
+                && putName(b, s, 1, 6) && putText(b, " = ") && putExpr(b, s, 3, " ", 1, 6) && putText(b, ";\n    }\n");
             break;
+        case 1:
+            ok = putText(b, "    if (") && putExpr(b, s, 3, " ", 1, 6) && putText(b, ")\n        return ")
+                && putExpr(b, s, 2, " ", 1, 6) && putText(b, ";\n    else\n        ")
+                && putName(b, s, 3, 10) && putText(b, "(") && putExpr(b, s, 1, " ", 1, 6) && putText(b, ", ")
+                && putExpr(b, s, 2, " ", 1, 6) && putText(b, ");\n");
+            break;
+        default:
+            ok = putText(b, "    ") && putName(b, s, 1, 6) && putText(b, " = ")
+                && putExpr(b, s, benchPick(s, 1, 5), " ", 1, 6) && putText(b, ";\n");
+            break;
+        }
+    }
+    return ok && putText(b, "}\n\n");
+}
+
+typedef struct {
+    const char* name;
+    int (*gen)(ByteBuf* b, unsigned long long* s); /* appends one piece of corpus */
+} BenchShape;
+
+static const BenchShape benchShapes[] = {
+    { "ids", genIds },
+    { "comments", genComments },
+    { "ops", genOps },
+    { "longlines", genLongLines },
+    { "mixed", genMixed },
+};
+#define NUMSHAPES ((int)(sizeof(benchShapes) / sizeof(benchShapes[0])))
+
+/* genCorpus fills b with at least size bytes of the given shape.
+   returns FALSE when out of memory */
+static int genCorpus(const BenchShape* shape, size_t size, ByteBuf* b)
+{
+    unsigned long long s = BENCHSEED ^ hashLexeme(shape->name, strlen(shape->name));
+    b->len = 0;
+    while (b->len < size)
+        if (!shape->gen(b, &s))
+            return FALSE;
+    return TRUE;
+}
+
+/* benchShape scans the corpus of one shape runs times and prints
+   the best run. returns FALSE when out of memory */
+static int benchShape(const BenchShape* shape, size_t size, int runs)
+{
+    ByteBuf b = { 0 };
+    double best = 0;
+    unsigned long long bestCycles = 0;
+    long long tokens = 0;
+    int lines = 0;
+    int r;
+    if (!genCorpus(shape, size, &b)) {
+        free(b.data);
+        return FALSE;
+    }
+    srcBuf = (const char*)b.data;
+    for (r = 0; r < runs; r++) {
+        double t0, t;
+        unsigned long long c0, c;
+        srcLen = b.len;
+        srcPos = lineEnd = 0;
+        lineno = 0;
+        EOF_flag = FALSE;
+        resumeState = START;
+        tokens = 0;
+        t0 = benchNow();
+        c0 = benchCycles();
+        while (getTokenQuiet() != ENDFILE)
+            tokens++;
+        c = benchCycles() - c0;
+        t = benchNow() - t0;
+        if (r == 0 || t < best) {
+            best = t;
+            bestCycles = c;
+        }
+        lines = lineno - 1;
+    }
+    srcBuf = NULL;
+    srcLen = srcPos = lineEnd = 0;
+    if (best <= 0) best = 1e-9;
+    printf("%s\t%zu\t%d\t%lld\t%.6f\t%.0f\t%.1f\t%.2f\n", shape->name, b.len, lines, tokens, best,
+        tokens / best, b.len / best / 1e6, (double)bestCycles / b.len);
+    free(b.data);
+    return TRUE;
+}
+
+/* findShape returns the shape called name, or NULL */
+static const BenchShape* findShape(const char* name)
+{
+    int i;
+    for (i = 0; i < NUMSHAPES; i++)
+        if (strcmp(benchShapes[i].name, name) == 0)
+            return &benchShapes[i];
+    return NULL;
+}
+
+/* benchMain runs scan -B <shape | all> [megabytes [runs]]
+   and scan -G <shape> <megabytes> <file> */
+static int benchMain(int argc, char* argv[])
+{
+    int generate = (strcmp(argv[1], "-G") == 0);
+    int all = !generate && argc > 2 && strcmp(argv[2], "all") == 0;
+    const BenchShape* shape = (argc > 2) ? findShape(argv[2]) : NULL;
+    double mb = (argc > 3) ? atof(argv[3]) : 16;
+    int runs = (!generate && argc > 4) ? atoi(argv[4]) : BENCHRUNS;
+    size_t size = (size_t)(mb * 1e6);
+    int i;
+
+    if ((shape == NULL && !all) || mb <= 0 || runs < 1 || argc > 5 || (generate && argc != 5)) {
+        fprintf(stderr, "usage: %s -B <shape | all> [megabytes [runs]]\n", argv[0]);
+        fprintf(stderr, "       %s -G <shape> <megabytes> <file>\n", argv[0]);
+        fprintf(stderr, "shapes:");
+        for (i = 0; i < NUMSHAPES; i++)
+            fprintf(stderr, " %s", benchShapes[i].name);
+        fprintf(stderr, "\n");
+        return 1;
+    }
+
+    if (generate) {
+        ByteBuf b = { 0 };
+        FILE* fp = fopen(argv[4], "wb");
+        int ok = (fp != NULL);
+        if (!genCorpus(shape, size, &b)) {
+            fprintf(stderr, "Out of memory error\n");
+            ok = FALSE;
+        }
+        else if (ok)
+            ok = fwrite(b.data, 1, b.len, fp) == b.len;
+        if (fp != NULL && fclose(fp) != 0) ok = FALSE;
+        free(b.data);
+        if (!ok) {
+            fprintf(stderr, "File %s could not be written\n", argv[4]);
+            return 1;
+        }
+        return 0;
+    }
+
+    printf("shape\tbytes\tlines\ttokens\tseconds\ttokens_per_s\tmb_per_s\tcycles_per_byte\n");
+    for (i = 0; i < NUMSHAPES; i++) {
+        if (!all && &benchShapes[i] != shape)
+            continue;
+        if (!benchShape(&benchShapes[i], size, runs)) {
+            fprintf(stderr, "Out of memory error\n");
+            return 1;
+        }
+        fflush(stdout);
+    }
+    return 0;
+}
+
+////////////////////////////////////////////////// CHECK.C 파일 ///////////////////////////////////////////
+/*
+Self-check (scan -T [source ...]). Every text is scanned once from the
+start with getTokenQuiet, and the other ways of scanning it must give
+the same tokens:
+
+    push   pushFeed over the whole text at once, one byte at a time
+           and over pieces of random sizes (kind, line and lexeme)
+    relex  a run of random edits (applyEdit), each followed by
+           relexTokens, against a full scan of the edited text
+           (kind, offset, length and line)
+
+Without sources it checks some short texts with awkward ends and a
+small corpus of every benchmark shape. It prints one line per text
+and returns 1 if any check failed.
+*/
+
+#define CHECKSIZE 65536 /* bytes of corpus per benchmark shape */
+#define CHECKSPLITS 8 /* random ways to cut a text for pushFeed */
+#define CHECKEDITS 200 /* random edits in a row for relexTokens */
+
+/* short texts that end in the middle of things */
+static const char* checkTexts[] = {
+    "",
+    "int x;\n",
+    "int x;",
+    "/* abc\ndef",
+    "/* abc\ndef\n",
+    "/* a\n * b\n */ x\n",
+    "/*",
+    "/* x *",
+    "/**/",
+    "x /",
+    "a<",
+    "a<=b!=c==d>=e\n",
+    "12abc 3",
+    "\n\n\n",
+    "! $ @ a!b",
+};
+#define NUMTEXTS ((int)(sizeof(checkTexts) / sizeof(checkTexts[0])))
+
+/* scanText scans text[0, len) from the start into tb.
+   returns FALSE when out of memory */
+static int scanText(const char* text, size_t len, TokenBuffer* tb)
+{
+    srcBuf = text;
+    srcLen = len;
+    srcPos = lineEnd = 0;
+    lineno = 0;
+    EOF_flag = FALSE;
+    resumeState = START;
+    tb->count = 0;
+    scanTokens(tb, 0);
+    srcBuf = NULL;
+    srcLen = srcPos = lineEnd = 0;
+    return tb->count > 0 && tb->kind[tb->count - 1] == ENDFILE;
+}
+
+/* PushCheck compares the tokens of a PushLexer with a full scan */
+typedef struct {
+    const TokenBuffer* ref; /* tokens of the full scan */
+    const char* text; /* the text ref was scanned from */
+    int next; /* index of the next token expected */
+    int bad; /* index of the first token that differed, or -1 */
+} PushCheck;
+
+/* checkToken is the sink of checkPush */
+static void checkToken(void* arg, TokenType token, int line, const char* s, size_t len)
+{
+    PushCheck* pc = (PushCheck*)arg;
+    const TokenBuffer* ref = pc->ref;
+    int i = pc->next++;
+    if (pc->bad >= 0)
+        return;
+    if (i >= ref->count || ref->kind[i] != token || ref->line[i] != line)
+        pc->bad = i;
+    else if (token != ENDFILE && token != STOP_BEFORE_END
+        && (len != (size_t)ref->length[i] || memcmp(s, pc->text + ref->offset[i], len) != 0))
+        pc->bad = i;
+}
+
+/* checkPush feeds text to a PushLexer in pieces of piece bytes, or
+   of random sizes if piece is 0, and returns the index of the first
+   token that differs from ref, or -1 if they all agree */
+static int checkPush(const char* text, size_t len, const TokenBuffer* ref, size_t piece, unsigned long long* s)
+{
+    PushLexer lx;
+    PushCheck pc;
+    size_t pos = 0;
+    pc.ref = ref;
+    pc.text = text;
+    pc.next = 0;
+    pc.bad = -1;
+    pushInit(&lx, checkToken, &pc);
+    while (pos < len) {
+        size_t n = piece;
+        if (n == 0)
+            n = (size_t)((benchPick(s, 0, 3) == 0) ? benchPick(s, 1, 4096) : benchPick(s, 1, 16));
+        if (n > len - pos)
+            n = len - pos;
+        pushFeed(&lx, text + pos, n);
+        pos += n;
+    }
+    pushFinish(&lx);
+    if (pc.bad < 0 && pc.next != ref->count)
+        pc.bad = (pc.next < ref->count) ? pc.next : ref->count - 1;
+    return pc.bad;
+}
 
-        case DONE:
-        default: /* should never happen */
-            fprintf(listing, "Scanner Bug: state= %d\n", state);
-            state = DONE;
-            currentToken = ERROR;
+/* text the random edits insert */
+static const char* checkInserts[] = {
+    "", "x", "12", " ", "\n", "/*", "*/", "*", "/", "<", "=", "<=", "!",
+    "if", "int y;\n", "{", "}",
+};
+#define NUMINSERTS ((int)(sizeof(checkInserts) / sizeof(checkInserts[0])))
+
+/* sameTokens tells whether a and b hold the same tokens */
+static int sameTokens(const TokenBuffer* a, const TokenBuffer* b)
+{
+    int i;
+    if (a->count != b->count)
+        return FALSE;
+    for (i = 0; i < a->count; i++)
+        if (a->kind[i] != b->kind[i] || a->offset[i] != b->offset[i]
+            || a->length[i] != b->length[i] || a->line[i] != b->line[i])
+            return FALSE;
+    return TRUE;
+}
+
+/* checkRelex makes CHECKEDITS random edits to text, one after the
+   other, keeping the tokens up to date with relexTokens. returns the
+   number of the first edit after which they differ from a full scan
+   of the edited text, or -1 if they never do */
+static int checkRelex(const char* text, size_t len, const TokenBuffer* ref, unsigned long long* s)
+{
+    TokenBuffer tb = { 0 }, full = { 0 };
+    char* cur;
+    size_t curLen;
+    int e, bad = -1;
+    while (tb.capacity < ref->count)
+        if (!growTokens(&tb)) {
+            fprintf(stderr, "Out of memory error\n");
+            exit(1);
+        }
+    memcpy(tb.kind, ref->kind, ref->count * sizeof(unsigned char));
+    memcpy(tb.offset, ref->offset, ref->count * sizeof(size_t));
+    memcpy(tb.length, ref->length, ref->count * sizeof(int));
+    memcpy(tb.line, ref->line, ref->count * sizeof(int));
+    tb.count = ref->count;
+    cur = applyEdit(text, len, 0, 0, "", 0, &curLen);
+    for (e = 0; e < CHECKEDITS && bad < 0 && cur != NULL; e++) {
+        const char* ins = checkInserts[benchPick(s, 0, NUMINSERTS - 1)];
+        size_t offset = (size_t)benchPick(s, 0, (int)curLen);
+        size_t removed = (size_t)benchPick(s, 0, 8);
+        size_t nextLen;
+        char* next;
+        if (removed > curLen - offset)
+            removed = curLen - offset;
+        next = applyEdit(cur, curLen, offset, removed, ins, strlen(ins), &nextLen);
+        free(cur);
+        cur = next;
+        if (cur == NULL || relexTokens(&tb, cur, nextLen, offset, removed, strlen(ins)) < 0
+            || !scanText(cur, nextLen, &full))
             break;
+        curLen = nextLen;
+        if (!sameTokens(&tb, &full))
+            bad = e;
+    }
+    if (e < CHECKEDITS && bad < 0) {
+        fprintf(stderr, "Out of memory error\n");
+        exit(1);
+    }
+    free(cur);
+    freeTokens(&tb);
+    freeTokens(&full);
+    return bad;
+}
+
+/* checkText runs the checks on text[0, len) and prints the outcome.
+   returns FALSE if a check failed */
+static int checkText(const char* name, const char* text, size_t len)
+{
+    TokenBuffer ref = { 0 };
+    unsigned long long s = BENCHSEED ^ len;
+    int bad, relexBad, k;
+    if (!scanText(text, len, &ref)) {
+        fprintf(stderr, "Out of memory error\n");
+        exit(1);
+    }
+    bad = checkPush(text, len, &ref, len, &s);
+    if (bad < 0)
+        bad = checkPush(text, len, &ref, 1, &s);
+    for (k = 0; k < CHECKSPLITS && bad < 0; k++)
+        bad = checkPush(text, len, &ref, 0, &s);
+    relexBad = checkRelex(text, len, &ref, &s);
+    printf("%s\t%zu\t%d\tpush %s\trelex %s\n", name, len, ref.count,
+        (bad < 0) ? "ok" : "FAIL", (relexBad < 0) ? "ok" : "FAIL");
+    if (bad >= 0)
+        printf("\tpush: first difference at token %d, line %d\n", bad, ref.line[bad]);
+    if (relexBad >= 0)
+        printf("\trelex: tokens differ after edit %d\n", relexBad);
+    freeTokens(&ref);
+    return bad < 0 && relexBad < 0;
+}
+
+/* checkMain runs scan -T [source ...] */
+static int checkMain(int argc, char* argv[])
+{
+    ByteBuf b = { 0 };
+    char name[32];
+    int i, ok = TRUE;
+    if (argc == 2) {
+        for (i = 0; i < NUMTEXTS; i++) {
+            snprintf(name, sizeof name, "text%d", i);
+            ok &= checkText(name, checkTexts[i], strlen(checkTexts[i]));
         }
-        if ((save) && (tokenStringIndex <= MAXTOKENLEN))
-            tokenString[tokenStringIndex++] = (char)c;
-        if (state == DONE) {
-            tokenString[tokenStringIndex] = '\0';
-            if (currentToken == ID)
-                currentToken = reservedLookup(tokenString);
+        for (i = 0; i < NUMSHAPES; i++) {
+            if (!genCorpus(&benchShapes[i], CHECKSIZE, &b)) {
+                fprintf(stderr, "Out of memory error\n");
+                exit(1);
+            }
+            ok &= checkText(benchShapes[i].name, (const char*)b.data, b.len);
         }
     }
-    if (TraceScan) {
-        fprintf(listing, "\t%d: ", lineno);
-        printToken(currentToken, tokenString);
+    for (i = 2; i < argc; i++) {
+        FILE* fp = fopen(argv[i], "rb");
+        size_t n;
+        if (fp == NULL) {
+            fprintf(stderr, "File %s not found\n", argv[i]);
+            ok = FALSE;
+            continue;
+        }
+        b.len = 0;
+        do {
+            if (!bufReserve(&b, STREAMCHUNK)) {
+                fprintf(stderr, "Out of memory error\n");
+                exit(1);
+            }
+            n = fread(b.data + b.len, 1, STREAMCHUNK, fp);
+            b.len += n;
+        } while (n > 0);
+        fclose(fp);
+        ok &= checkText(argv[i], (const char*)b.data, b.len);
     }
-    return currentToken;
-} /* end getToken */
+    free(b.data);
+    return ok ? 0 : 1;
+}
 
 ///////////////////////////////////////////////////   MAIN.C 파일    //////////////////////////
 int main(int argc, char* argv[]) {
     char PFile[120]; /* 스캔한 결과 출력대상 파일*/
     char SFile[120]; /* source code file name */
-    if (argc != 3)
+    int threads = 1; /* -j: number of scanning threads */
+    int binary = FALSE; /* -b: write a binary token file instead of a listing */
+    int readBack = FALSE; /* -r: the source is a token file to be listed */
+    int fromStdin; /* source "-": scan stdin as it arrives */
+    int damaged = FALSE; /* -r: the token file ended in a bad record */
+    int argi = 1;
+
+    if (argc > 1 && (strcmp(argv[1], "-B") == 0 || strcmp(argv[1], "-G") == 0))
+        return benchMain(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "-T") == 0)
+        return checkMain(argc, argv);
+
+    while (argi < argc && argv[argi][0] == '-') {
+        if (strcmp(argv[argi], "-j") == 0 && argi + 1 < argc) {
+            threads = atoi(argv[argi + 1]);
+            argi += 2;
+        }
+        else if (strcmp(argv[argi], "-b") == 0) {
+            binary = TRUE;
+            argi++;
+        }
+        else if (strcmp(argv[argi], "-r") == 0) {
+            readBack = TRUE;
+            argi++;
+        }
+        else
+            break;
+    }
+    fromStdin = (argc - argi == 2 && strcmp(argv[argi], "-") == 0);
+    if (argc - argi != 2 || threads < 1 || (binary && readBack) || (fromStdin && threads > 1))
     {
-        fprintf(stderr, "usage: %s <filename>\n", argv[0]);
+        fprintf(stderr, "usage: %s [-j threads] [-b | -r] <source | -> <listing>\n", argv[0]);
+        fprintf(stderr, "       %s -B <shape | all> [megabytes [runs]]\n", argv[0]);
+        fprintf(stderr, "       %s -T [source ...]\n", argv[0]);
         exit(1);
     }
 
     //source code file 처리작업
-    strcpy(SFile, argv[1]);
-    if (strchr(SFile, '.') == NULL)
-        strcat(SFile, ".c");
-    source = fopen(SFile, "r");
+    strcpy(SFile, argv[argi]);
+    if (fromStdin)
+        source = stdin;
+    else {
+        if (strchr(SFile, '.') == NULL && !readBack)
+            strcat(SFile, ".c");
+        source = fopen(SFile, readBack ? "rb" : "r");
+    }
 
     // 스캔한 결과 출력대상 file 처리작업
-    strcpy(PFile, argv[2]);
+    strcpy(PFile, argv[argi + 1]);
     if (strchr(PFile, '.') == NULL)
         strcat(PFile, ".txt");
-    listing = fopen(PFile, "w");
+    listing = fopen(PFile, binary ? "wb" : "w");
 
     if (source == NULL)
     {
         fprintf(stderr, "File %s not found\n", SFile);
         exit(1);
     }
-    //fprintf(listing, "\nTINY COMPILATION: %s\n", SFile); // 그냥 TINY COMPILATION으로 칭함.
-    fprintf(listing, "\nC- language: %s\n", SFile);
+    if ((!fromStdin || readBack) && !mapSource(source))
+    {
+        fprintf(stderr, "File %s could not be read\n", SFile);
+        exit(1);
+    }
 
+    if (readBack) {
+        TokenFile tf;
+        if (!openTokenFile(&tf, srcBuf, srcLen)) {
+            fprintf(stderr, "File %s is not a token file\n", SFile);
+            exit(1);
+        }
+        outText("\nC- tokens: ");
+        outText(SFile);
+        outChar('\n');
+        if (!listTokens(&tf)) {
+            fprintf(stderr, "File %s is damaged\n", SFile);
+            damaged = TRUE;
+        }
+    }
+    else if (binary) {
+        TokenWriter w = { 0 };
+        EchoSource = FALSE;
+        TraceScan = FALSE;
+        if (fromStdin)
+            scanStream(source, &w);
+        else if (threads > 1)
+            scanParallel(threads, &w);
+        else
+            writeTokens(&w);
+        if (!tokFinish(&w, listing)) {
+            fprintf(stderr, "File %s could not be written\n", PFile);
+            exit(1);
+        }
+    }
+    else {
+        //fprintf(listing, "\nTINY COMPILATION: %s\n", SFile); // 그냥 TINY COMPILATION으로 칭함.
+        outText("\nC- language: ");
+        outText(SFile);
+        outChar('\n');
 
-    while (getToken() != ENDFILE);
+        if (fromStdin)
+            scanStream(source, NULL);
+        else if (threads > 1)
+            scanParallel(threads, NULL);
+        else
+            while (getToken() != ENDFILE);
+    }
 
-    return 0;
-}
\ No newline at end of file
+    outFlush();
+    unmapSource();
+    return damaged ? 1 : 0;
+}